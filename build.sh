@@ -35,4 +35,4 @@ else
   echo "WARNING: validation layer json not found at ${LAYER_JSON}"
 fi
 
-exec "${BUILD_DIR}/vulkan_app"
+exec "${BUILD_DIR}/vulkan_app" "${@:2}"
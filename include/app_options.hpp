@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace vkmini {
+
+// Command-line options shared by the windowed and headless paths.
+struct AppOptions {
+    bool headless = false;      // --headless (always on in VKMINI_HEADLESS builds)
+    bool headlessSurface = false; // --headless-surface: full swapchain path on VK_EXT_headless_surface, no window system
+    std::string windowScript;   // --window-script "MS action; ...": resizes/minimizes/quit for --headless-surface
+    uint32_t frames = 0;        // --frames N; 0 renders until the window closes (headless: 100)
+    uint32_t width = 1280;      // --size WxH: window size, or the offscreen target size
+    uint32_t height = 720;
+    std::string readback;       // --readback out.ppm: headless, write the last frame as binary PPM
+    uint32_t instances = 1;     // --instances N: cubes drawn by the one instanced draw (stress test)
+    bool gpuCull = false;       // --gpu-cull: frustum-cull instances in a compute pass, draw indirect
+    bool cpuCull = false;       // --cpu-cull: frustum-cull instances on the CPU (SIMD, split into jobs)
+    bool drawPerInstance = false; // --draw-per-instance: one draw call per instance instead of one instanced draw
+    uint32_t streamTexture = 0; // --stream-texture N: re-upload the texture on the transfer queue every N frames (0: off)
+    uint32_t recordThreads = 0; // --record-threads N: record the draw list into up to N secondaries as jobs (0: inline)
+    uint32_t framesInFlight = 2; // --frames-in-flight N: frames the CPU may record ahead of the GPU (1..8)
+    uint32_t resizeDebounceMs = 100; // --resize-debounce MS: rebuild the swapchain once a resize has been still this long
+    bool resizeReplay = false;  // --resize-replay: resize-coalescing self-check on synthetic events, no window system
+    uint32_t swapchainImages = 0; // --swapchain-images N: requested image count, clamped to the surface (0: auto)
+
+    // --bench N: run exactly N frames (stored in `frames`; exclusive with --frames) on a fixed
+    // timestep and report per-phase CPU timings as JSON.
+    bool bench = false;
+    std::string benchOut;       // --bench-out report.json (default: stdout)
+    std::string benchCompare;   // --bench-compare baseline.json: exit code 3 on a regression
+    double benchThreshold = 0.10; // --bench-threshold PERCENT
+
+    bool gpuProfile = false;    // --gpu-profile: timestamp zones + pipeline statistics, summary on exit
+    std::string trace;          // --trace out.json: CPU zones (and GPU zones with --gpu-profile) as a Chrome trace
+                                // --gpu-trace out.json is --trace out.json --gpu-profile
+};
+
+// Throws std::runtime_error (with usage text) on unknown or malformed arguments.
+AppOptions parse_options(int argc, char** argv);
+
+} // namespace vkmini
@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace vkmini {
+
+// Per-frame phases timed in --bench mode. Headless runs have no Acquire/Present samples.
+enum class BenchPhase : uint8_t { Frame, Wait, Acquire, Record, Submit, Present, Count };
+inline constexpr size_t kBenchPhaseCount = size_t(BenchPhase::Count);
+
+const char* bench_phase_name(BenchPhase p);
+
+struct PhaseStats {
+    uint32_t samples = 0;
+    double min = 0, mean = 0, p50 = 0, p95 = 0, p99 = 0, max = 0; // milliseconds
+};
+
+struct BenchInfo {
+    std::string device;
+    std::string mode;      // "headless" or "windowed"
+    uint32_t width = 0, height = 0;
+};
+
+// Collects per-phase CPU timings for a fixed number of frames. The first `warmup` frames
+// (pipeline and driver warm-up) are run but not recorded. A frame's samples are held until
+// end_frame() records them with the Frame phase, so an iteration that is abandoned (minimized,
+// waiting for a swapchain rebuild, failed acquire) leaves no samples behind.
+class BenchRecorder {
+public:
+    void start(uint32_t frames, uint32_t warmup);
+    bool active() const { return active_; }
+
+    // Call at the top of every loop iteration; drops the samples of an iteration that did not
+    // reach end_frame().
+    void begin_frame();
+    // Call once the frame has been submitted (and presented); records it.
+    void end_frame();
+    void add(BenchPhase p, double ms)
+    {
+        if (!active_) return;
+        pending_[size_t(p)] = ms;
+        pendingMask_ |= 1u << size_t(p);
+    }
+
+    PhaseStats stats(BenchPhase p) const;
+    std::string to_json(const BenchInfo& info) const;
+
+    // Compares p50 and p95 of every phase against a report written by to_json. A phase regresses
+    // when it is slower by more than `threshold` (fraction) and by more than a small absolute
+    // noise floor. Writes a table to `out`; returns false on any regression. Throws on a bad file.
+    bool compare(const std::string& baselinePath, double threshold, std::ostream& out) const;
+
+private:
+    bool active_ = false;
+    uint32_t frames_ = 0, warmup_ = 0, frame_ = 0; // frame_: frames ended
+    std::array<std::vector<double>, kBenchPhaseCount> samples_;
+    std::array<double, kBenchPhaseCount> pending_{}; // this frame's samples
+    uint32_t pendingMask_ = 0;
+    std::chrono::steady_clock::time_point frameStart_{};
+};
+
+// Times its scope into `phase`; does nothing when the recorder is inactive.
+class BenchScope {
+public:
+    BenchScope(BenchRecorder& r, BenchPhase phase) : r_(r), phase_(phase)
+    {
+        if (r_.active()) t0_ = std::chrono::steady_clock::now();
+    }
+    ~BenchScope()
+    {
+        if (r_.active())
+            r_.add(phase_, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0_).count());
+    }
+    BenchScope(const BenchScope&) = delete;
+    BenchScope& operator=(const BenchScope&) = delete;
+
+private:
+    BenchRecorder& r_;
+    BenchPhase phase_;
+    std::chrono::steady_clock::time_point t0_{};
+};
+
+// --bench-selftest N: CPU-only self-check of the recorder (staging, warm-up, percentiles), of the
+// JSON report round trip over N frames and of compare()'s threshold and noise floor. Returns the
+// process exit code.
+int run_bench_selftest(uint32_t frames);
+
+} // namespace vkmini
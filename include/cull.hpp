@@ -0,0 +1,68 @@
+#pragma once
+#include "jobs.hpp"
+#include "math.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace vkmini {
+
+// Six clip planes (left, right, bottom, top, near, far) as (nx, ny, nz, d), normals pointing inside
+// and unit length: a point p is inside a plane when dot(n, p) + d >= 0.
+struct Frustum { float planes[6][4]; };
+
+// Planes of a projection*view transform with Vulkan's 0..1 clip depth.
+Frustum extract_frustum(const Mat4& viewProj);
+
+// Bounding volumes in structure-of-arrays form, one lane per object, so the kernels test 4 (SSE2)
+// or 8 (AVX2) objects per instruction. All arrays of one set must have the same size.
+struct SphereSoA {
+    std::vector<float> x, y, z, r;
+    size_t size() const { return x.size(); }
+    void push_back(float cx, float cy, float cz, float radius);
+};
+// Center and half extents.
+struct AabbSoA {
+    std::vector<float> cx, cy, cz, ex, ey, ez;
+    size_t size() const { return cx.size(); }
+    void push_back(float x, float y, float z, float hx, float hy, float hz);
+};
+
+// Single-threaded kernels over objects [begin, end). Writes the indices of the objects that are
+// not fully outside any plane to out (room for end - begin), in ascending order; returns the count.
+size_t cull_spheres(const Frustum& f, const SphereSoA& s, size_t begin, size_t end, uint32_t* out);
+size_t cull_aabbs(const Frustum& f, const AabbSoA& b, size_t begin, size_t end, uint32_t* out);
+
+// Objects per kernel call, as selected at compile time with the math kernels: 8, 4 or 1.
+uint32_t cull_lanes();
+
+// Splits a batch into chunks run as jobs on a JobSystem, the calling thread taking the first, and
+// writes one compact, ascending list of visible indices. Batches too small to amortize the handoff
+// stay on the calling thread. One batch at a time: cull() is not reentrant.
+class CpuCuller {
+public:
+    explicit CpuCuller(JobSystem& jobs) : jobs_(jobs) {}
+    CpuCuller(const CpuCuller&) = delete;
+    CpuCuller& operator=(const CpuCuller&) = delete;
+
+    uint32_t threads() const { return jobs_.threads(); }
+
+    // visible.size() must be >= the object count. Returns the number of indices written.
+    size_t cull(const Frustum& f, const SphereSoA& s, std::span<uint32_t> visible);
+    size_t cull(const Frustum& f, const AabbSoA& b, std::span<uint32_t> visible);
+
+private:
+    using Kernel = size_t (*)(const Frustum&, const void*, size_t, size_t, uint32_t*);
+
+    size_t run(Kernel kernel, const void* soa, size_t count, const Frustum& f, std::span<uint32_t> visible);
+
+    JobSystem& jobs_;
+    std::vector<size_t> written_; // per chunk
+};
+
+// --cull-bench N: CPU-only microbenchmark of the kernels and the threaded batch over N random
+// spheres and boxes, checked against a scalar reference. Returns the process exit code.
+int run_cull_bench(uint32_t objects);
+
+} // namespace vkmini
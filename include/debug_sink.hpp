@@ -0,0 +1,82 @@
+#pragma once
+#include "mpsc_queue.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace vkmini {
+
+enum class DebugSeverity : uint32_t { Verbose, Info, Warning, Error };
+
+// Every message a DebugSink has received since start.
+struct DebugMessageStats {
+    uint64_t errors = 0, warnings = 0, info = 0, verbose = 0;
+    uint64_t performance = 0; // performance-type messages, any severity
+    uint64_t repeats = 0;     // folded into an earlier printed message with the same id (printed as counts)
+    uint64_t rateLimited = 0; // first occurrences not printed: over their severity's rate
+    uint64_t dropped = 0;     // ring full: counted above, never printed
+};
+
+// The debug messenger's callback runs on whatever thread the driver or layer raises it from, often
+// the render thread inside a vkQueueSubmit. post() only counts the message and copies it into a
+// lock-free ring; a background thread formats and writes it. Repeats of a message id are folded
+// into one line per second with a count, and first occurrences are rate limited per severity, so a
+// flood of INFO costs the calling thread a copy and the output a handful of lines. No Vulkan types,
+// so it can be exercised on the CPU.
+class DebugSink {
+public:
+    // First occurrences printed per second, per severity; one second's worth may come in a burst.
+    static constexpr std::array<double, 4> kDefaultRates = { 10, 20, 50, 200 };
+
+    explicit DebugSink(std::ostream& out, std::array<double, 4> ratePerSecond = kDefaultRates);
+    ~DebugSink(); // writes what is queued and the pending repeat counts
+    DebugSink(const DebugSink&) = delete;
+    DebugSink& operator=(const DebugSink&) = delete;
+
+    // Any thread; never blocks or allocates. Null strings are allowed.
+    void post(DebugSeverity severity, bool performance, int32_t id, const char* idName, const char* text);
+
+    // Waits until everything posted so far has been written.
+    void flush();
+    DebugMessageStats stats() const;
+
+private:
+    // What post() copies out of the driver's callback data: fixed size, so the ring is a plain
+    // array and posting never allocates.
+    struct Message {
+        uint32_t severity = 0; // DebugSeverity
+        int32_t id = 0;        // messageIdNumber
+        char idName[96];
+        char text[1024];
+    };
+    struct Seen {
+        std::string label;       // how the report line names the message
+        uint64_t unreported = 0; // repeats since the last report line
+    };
+
+    void run();
+    void handle(const Message& m, std::array<double, 4>& tokens);
+    void report_repeats();
+
+    std::ostream& out_;
+    const std::array<double, 4> rates_;
+    MpscQueue<Message, 256> ring_;
+    std::array<std::atomic<uint64_t>, 4> counts_{};
+    std::atomic<uint64_t> performance_{0}, repeats_{0}, rateLimited_{0}, dropped_{0};
+    std::atomic<uint64_t> posted_{0}, handled_{0};
+    std::atomic<bool> stop_{false};
+    std::unordered_map<std::string, Seen> seen_; // writer thread only
+    std::thread thread_; // last: starts once everything above is constructed
+};
+
+// --debug-sink-bench N: CPU-only self-check of MpscQueue (N items from several producers, nothing
+// lost or duplicated, full-ring pushes refused) and of DebugSink (folding by id, name and text,
+// the rate limit, drops counted) plus the cost of post() from several threads. Returns the
+// process exit code.
+int run_debug_sink_bench(uint32_t messages);
+
+} // namespace vkmini
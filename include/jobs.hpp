@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkmini {
+
+class JobCounter;
+
+struct Job {
+    std::function<void()> fn;
+    JobCounter* counter = nullptr;
+};
+
+// Tracks a group of jobs: incremented when a job is scheduled against it, decremented when the job
+// returns. JobSystem::wait returns once it is back at zero, and jobs scheduled with run_after start
+// then. The first exception thrown by one of its jobs is rethrown by wait, and skips the jobs that
+// were to run after it. Must outlive its jobs.
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool done() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> pending_{0};
+    std::mutex m_;
+    std::vector<Job> continuations_; // scheduled when pending_ reaches zero
+    std::exception_ptr error_;
+};
+
+// Work-stealing scheduler. Every worker owns a deque: it pushes and pops its own jobs at the back
+// (newest first, cache-warm) and steals the oldest job from the front of another deque when its own
+// is empty. Threads outside the pool share one more deque. There are no fibers: a thread that
+// waits on a counter runs queued jobs until the counter drains, and sleeps only when there is
+// nothing left to run.
+class JobSystem {
+public:
+    static constexpr uint32_t kAutoWorkers = ~0u; // hardware_concurrency() - 1
+
+    // workers: background threads besides the threads that call wait().
+    explicit JobSystem(uint32_t workers = kAutoWorkers);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Workers plus one waiting thread.
+    uint32_t threads() const { return uint32_t(workers_.size()) + 1; }
+
+    // Schedules fn; counter (may be null) tracks it.
+    void run(JobCounter* counter, std::function<void()> fn);
+    // Schedules fn once `dependency` reaches zero (immediately if it already is).
+    void run_after(JobCounter& dependency, JobCounter* counter, std::function<void()> fn);
+
+    // Runs queued jobs until counter reaches zero, then rethrows its first job exception.
+    void wait(JobCounter& counter);
+    // Same, but drops the exception; for unwinding paths.
+    void drain(JobCounter& counter) noexcept;
+
+    // Runs fn over [0, count) in up to threads() contiguous ranges of at least `grain` items, the
+    // first on the calling thread, and waits for all of them.
+    void parallel_for(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& fn);
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<Job> jobs;
+    };
+
+    void push(Job job);
+    bool try_pop(Job& out);
+    void execute(Job& job);
+    void finish(JobCounter* counter);
+    void skip(Job& job, std::exception_ptr error);
+    void worker(uint32_t index);
+
+    std::vector<std::unique_ptr<Queue>> queues_; // [0] shared by outside threads, [i] owned by worker i
+    std::vector<std::thread> workers_;
+    std::atomic<uint32_t> queued_{0};
+    std::mutex sleepM_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};
+
+// A counter its JobSystem also drains on scope exit, so an exception thrown while the jobs run
+// cannot leave them touching destroyed locals.
+class ScopedJobs {
+public:
+    explicit ScopedJobs(JobSystem& jobs) : jobs_(jobs) {}
+    ~ScopedJobs() { jobs_.drain(counter_); }
+    ScopedJobs(const ScopedJobs&) = delete;
+    ScopedJobs& operator=(const ScopedJobs&) = delete;
+
+    void run(std::function<void()> fn) { jobs_.run(&counter_, std::move(fn)); }
+    void wait() { jobs_.wait(counter_); }
+    JobCounter& counter() { return counter_; }
+
+private:
+    JobSystem& jobs_;
+    JobCounter counter_;
+};
+
+// --job-bench N: CPU-only self-check and benchmark of the scheduler (fan-out, dependencies, nested
+// waits, parallel_for) with N jobs per run. Returns the process exit code.
+int run_job_bench(uint32_t jobs);
+
+} // namespace vkmini
@@ -1,8 +1,11 @@
 #pragma once
 #include <array>
+#include <cstdint>
+#include <span>
 namespace vkmini {
 
-struct Mat4 { std::array<float,16> m{}; };
+// Column-major 4x4, element (row, col) lives at m[row + col*4].
+struct alignas(16) Mat4 { std::array<float,16> m{}; };
 
 Mat4 identity();
 Mat4 perspective(float fovyRadians, float aspect, float zn, float zf);
@@ -11,4 +14,18 @@ Mat4 rotate_x(float r);
 Mat4 rotate_y(float r);
 Mat4 mul(const Mat4& a, const Mat4& b);
 
+// Batched kernels. out.size() must be >= the input count; out may alias an input span.
+// out[i] = a * b[i]  (e.g. one view-projection times N model matrices)
+void mul_batch(const Mat4& a, std::span<const Mat4> b, std::span<Mat4> out);
+// out[i] = a[i] * b[i]
+void mul_batch(std::span<const Mat4> a, std::span<const Mat4> b, std::span<Mat4> out);
+
+// Name of the kernel set selected at compile time: "avx2", "sse2" or "scalar".
+const char* math_backend();
+
+// --math-bench N: CPU-only check of mul and both mul_batch overloads (aliasing, size checks)
+// against a scalar reference on N random matrices and of the instance transforms' translation
+// shortcut, plus their throughput. Returns the process exit code.
+int run_math_bench(uint32_t matrices);
+
 } // namespace vkmini
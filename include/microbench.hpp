@@ -0,0 +1,11 @@
+#pragma once
+#include <functional>
+
+namespace vkmini {
+
+// Timing shared by the CPU microbenchmarks: runs fn at least 10 times and for at least a quarter
+// of a second, and reports the fastest and the median run.
+struct BenchTiming { double minMs = 0, medianMs = 0; };
+BenchTiming time_runs(const std::function<void()>& fn);
+
+} // namespace vkmini
@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace vkmini {
+
+// Bounded multi-producer single-consumer ring without locks (Vyukov's sequenced slots): any
+// number of threads push(), one thread pop()s. A producer claims a slot with one CAS on the head,
+// fills it, then publishes it through the slot's sequence number, so a slow producer only delays
+// the consumer at its own slot and never blocks the other producers. N must be a power of two.
+template<class T, size_t N>
+class MpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscQueue size must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    MpscQueue() : slots_(std::make_unique<Slot[]>(N))
+    {
+        for (size_t i=0;i<N;++i) slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    // Any thread. False (and nothing queued) when the ring is full. `fill` writes the item in place.
+    template<class Fill>
+    bool push(Fill&& fill)
+    {
+        uint64_t pos = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot& slot = slots_[pos & (N - 1)];
+            const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            const int64_t diff = int64_t(seq) - int64_t(pos);
+            if (diff == 0)
+            {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    fill(slot.item);
+                    slot.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) return false; // the consumer has not freed this slot yet
+            else pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Consumer thread. False when the next slot is empty or still being written.
+    bool pop(T& out)
+    {
+        Slot& slot = slots_[tail_ & (N - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != tail_ + 1) return false;
+        out = slot.item;
+        slot.seq.store(tail_ + N, std::memory_order_release);
+        ++tail_;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq;
+        T item;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<uint64_t> head_{0}; // next slot a producer claims
+    alignas(64) uint64_t tail_ = 0;             // consumer only
+};
+
+} // namespace vkmini
@@ -1,10 +1,42 @@
 #pragma once
+#include <chrono>
 #include <cstdint>
 #include <string_view>
 
 namespace vkmini {
 
 struct FramebufferSize { uint32_t w=0, h=0; };
+inline bool operator==(FramebufferSize a, FramebufferSize b) { return a.w == b.w && a.h == b.h; }
+
+// Framebuffer size as seen through a window system's configure events. A drag-resize queues one
+// event per motion step; a backend feeds every one to configure() and calls end_pump() once per
+// pump, so only the last size of a pump is applied. settled() turns true once the size has not
+// changed for the debounce window, which is when the renderer should rebuild its swapchain.
+class ResizeCoalescer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ResizeCoalescer(FramebufferSize initial, std::chrono::milliseconds debounce)
+        : size_(initial), debounce_(debounce) {}
+
+    void configure(FramebufferSize size);
+    // Applies the last configured size, if it differs from the current one, as a change at `now`.
+    void end_pump(Clock::time_point now);
+
+    FramebufferSize size() const { return size_; }
+    bool minimized() const { return size_.w == 0 || size_.h == 0; }
+    bool settled(Clock::time_point now) const;
+
+    uint64_t events() const { return events_; }   // configure events seen
+    uint64_t changes() const { return changes_; } // sizes applied
+
+private:
+    FramebufferSize size_, pending_;
+    bool hasPending_ = false;
+    std::chrono::milliseconds debounce_;
+    Clock::time_point lastChange_{};
+    uint64_t events_ = 0, changes_ = 0;
+};
 
 struct NativeWindow {
 #if defined(_WIN32)
@@ -17,10 +49,13 @@ struct NativeWindow {
     void* xcb_connection = nullptr; // xcb_connection_t*
     std::uint32_t xcb_window = 0;   // xcb_window_t
 #endif
+    bool headless = false; // no native handles: present to a VK_EXT_headless_surface
 };
 
 class IPlatformWindow {
 public:
+    static constexpr std::chrono::milliseconds kNoTimeout = std::chrono::milliseconds::max();
+
     virtual ~IPlatformWindow() = default;
 
     virtual NativeWindow native() const = 0;
@@ -29,12 +64,20 @@ public:
     // Returns false when the app should quit.
     virtual bool pump_events() = 0;
 
-    // Blocks until at least one event is available (used during resize/minimize).
-    virtual void wait_events() = 0;
+    // Blocks until at least one event has been handled, wake() is called or `timeout` has passed
+    // (kNoTimeout: no limit). Used while minimized and by the event thread between pumps.
+    virtual void wait_events(std::chrono::milliseconds timeout) = 0;
+
+    // Any thread: makes the wait_events() in progress, or else the next one, return.
+    virtual void wake() = 0;
 
     // True if the window is currently minimized / has zero drawable size.
     virtual bool is_minimized() const = 0;
 
+    // False while the framebuffer size is still changing (see ResizeCoalescer). Backends that do
+    // not coalesce report every size as settled.
+    virtual bool resize_settled() const { return true; }
+
     virtual const char* platform_name() const = 0;
 };
 
@@ -42,9 +85,21 @@ struct WindowCreateInfo {
     const char* title = "Vulkan App";
     uint32_t width = 1280;
     uint32_t height = 720;
+    uint32_t resizeDebounceMs = 100; // resize_settled() window
+    // Headless backend instead of the platform's: no window system, VK_EXT_headless_surface, and the
+    // window's resizes, minimizes and quit played from `script` (see --window-script).
+    bool headlessSurface = false;
+    std::string_view script;
 };
 
+// Throws std::runtime_error on a malformed headless window script.
 IPlatformWindow* create_platform_window(const WindowCreateInfo& ci);
 void destroy_platform_window(IPlatformWindow* wnd);
 
+// --resize-replay: replays scripted configure-event sequences (drag storms, moves, minimize) through
+// the XCB backend's event handling on a synthetic clock and checks the swapchain rebuilds the
+// render thread's SwapchainRebuildPolicy makes, with and without out-of-date presents. Needs no
+// window system (XCB platforms only). Returns the process exit code.
+int run_resize_replay();
+
 } // namespace vkmini
@@ -0,0 +1,29 @@
+#pragma once
+#if !defined(_WIN32) && !defined(__ANDROID__)
+
+#include "platform.hpp"
+#include <xcb/xcb.h>
+
+namespace vkmini {
+
+// What the XCB backend makes of its events, apart from the connection: the framebuffer size
+// (through ResizeCoalescer) and whether the window is still open. The window feeds it every event
+// it reads and ends each pump with end_pump(); --resize-replay feeds it synthetic ones.
+class XcbEventHandler {
+public:
+    XcbEventHandler(FramebufferSize initial, std::chrono::milliseconds debounce) : resize_(initial, debounce) {}
+
+    void handle(const xcb_generic_event_t* ev);
+    void end_pump(ResizeCoalescer::Clock::time_point now) { resize_.end_pump(now); }
+
+    const ResizeCoalescer& resize() const { return resize_; }
+    bool alive() const { return alive_; }
+
+private:
+    ResizeCoalescer resize_;
+    bool alive_ = true;
+};
+
+} // namespace vkmini
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace vkmini {
+
+// Bounded single-producer single-consumer ring without locks: push() is called from one thread and
+// pop() from one other. Each side owns one index and reads the other's with acquire ordering, so a
+// popped slot is always fully written. Holds N - 1 items; N must be a power of two.
+template<class T, size_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    // Producer. False (and nothing queued) when the ring is full.
+    bool push(const T& v)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t next = (head + 1) & (N - 1);
+        if (next == tail_.load(std::memory_order_acquire)) return false;
+        slots_[head] = v;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer. False when the ring is empty.
+    bool pop(T& out)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        out = slots_[tail];
+        tail_.store((tail + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head_{0}; // next slot the producer writes
+    alignas(64) std::atomic<size_t> tail_{0}; // next slot the consumer reads
+    alignas(64) std::array<T, N> slots_{};
+};
+
+} // namespace vkmini
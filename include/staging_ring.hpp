@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace vkmini {
+
+// Space bookkeeping of UploadContext's staging ring. Pure bookkeeping, no Vulkan calls, so the
+// policy can be exercised on the CPU.
+//
+// Ranges are taken in submission order, each tagged with the ticket of the batch that reads it,
+// and given back in that order once the batch completes; the occupied part runs from the oldest
+// range to the newest, possibly wrapping past the end.
+class StagingRing {
+public:
+    StagingRing() = default;
+    StagingRing(uint64_t capacity, uint64_t alignment) : capacity_(capacity), alignment_(alignment) {}
+
+    // Where `bytes` contiguous bytes fit (aligned), or nullopt until older ranges are released.
+    std::optional<uint64_t> find(uint64_t bytes) const;
+    // Marks [offset, offset + bytes) as read by batch `ticket`; offset comes from find().
+    void occupy(uint64_t offset, uint64_t bytes, uint64_t ticket);
+    // Gives back the ranges of every batch up to and including `completedTicket`.
+    void release(uint64_t completedTicket);
+
+    uint64_t capacity() const { return capacity_; }
+    bool empty() const { return occupied_.empty(); }
+
+private:
+    struct Range {
+        uint64_t ticket = 0;
+        uint64_t begin = 0, end = 0;
+    };
+
+    std::deque<Range> occupied_; // allocation order
+    uint64_t capacity_ = 0;
+    uint64_t alignment_ = 1;
+};
+
+} // namespace vkmini
@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <iosfwd>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkmini {
+
+// Time-to-first-frame breakdown. Startup phases are timed on whichever thread runs them, relative
+// to process start (static initialization of this module), and printed as one table once the first
+// frame is out, so overlap between phases shows as overlapping start/end columns. Thread-safe.
+class StartupReport {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Times its scope as phase `name` (a string literal).
+    class Phase {
+    public:
+        Phase(StartupReport& r, const char* name) : r_(r), name_(name), begin_(Clock::now()) {}
+        ~Phase() { r_.add(name_, begin_, Clock::now()); }
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+    private:
+        StartupReport& r_;
+        const char* name_;
+        Clock::time_point begin_;
+    };
+
+    StartupReport() : main_(std::this_thread::get_id()) {}
+
+    static Clock::time_point process_start();
+
+    void add(const char* name, Clock::time_point begin, Clock::time_point end);
+    // setup() returned; the gap to the first frame is reported as its own phase.
+    void setup_done() { setupDone_ = Clock::now(); }
+    // Render thread, once the first frame is presented (submitted, headless). Prints the report to
+    // `out` on the first call only.
+    void first_frame(std::ostream& out);
+
+private:
+    struct Entry {
+        const char* name;
+        Clock::time_point begin, end;
+        bool main;
+    };
+
+    std::thread::id main_;
+    std::mutex m_;
+    std::vector<Entry> entries_;
+    Clock::time_point setupDone_{};
+    bool reported_ = false;
+};
+
+} // namespace vkmini
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <optional>
+
+namespace vkmini {
+
+// Placement policy for one device memory block. Pure bookkeeping, no Vulkan calls, so the
+// policy can be exercised on the CPU.
+//
+// Linear resources (buffers, linear-tiled images) and optimal-tiled images must not share a
+// bufferImageGranularity page; ranges of different kinds that would touch the same page are
+// pushed apart.
+enum class ResourceKind : uint8_t { Linear, Optimal };
+
+struct BlockStats {
+    uint64_t size = 0;
+    uint64_t used = 0;
+    uint64_t largestFree = 0;
+    uint32_t allocations = 0;
+    uint32_t freeRanges = 0;
+};
+
+class BlockSuballocator {
+public:
+    BlockSuballocator(uint64_t size, uint64_t granularity);
+
+    // Best-fit. Returns the offset of the new range, or nullopt if it does not fit.
+    std::optional<uint64_t> allocate(uint64_t size, uint64_t alignment, ResourceKind kind);
+    // Returns false, changing nothing, when `offset` is not the start of a live allocation (a
+    // double or foreign free). Never throws, so handles can free from their destructors.
+    bool free(uint64_t offset) noexcept;
+
+    bool empty() const { return allocations_ == 0; }
+    uint64_t size() const { return size_; }
+    BlockStats stats() const;
+
+private:
+    struct Range {
+        uint64_t size = 0;
+        bool free = true;
+        ResourceKind kind = ResourceKind::Linear;
+    };
+    using Map = std::map<uint64_t, Range>; // keyed by offset, covers the whole block
+
+    bool conflicts_before(Map::const_iterator it, uint64_t offset, ResourceKind kind) const;
+    bool conflicts_after(Map::const_iterator it, uint64_t end, ResourceKind kind) const;
+    void add_free(uint64_t offset, uint64_t size);
+    void remove_free(uint64_t offset, uint64_t size);
+
+    Map ranges_;
+    std::multimap<uint64_t, uint64_t> freeBySize_; // size -> offset, for best-fit lookup
+    uint64_t size_ = 0;
+    uint64_t granularity_ = 1;
+    uint64_t used_ = 0;
+    uint32_t allocations_ = 0;
+};
+
+// --alloc-bench N: CPU-only self-check of the placement policy (alignment, granularity separation,
+// free and coalescing, fragmentation stats) and of the staging ring (StagingRing), and an
+// alloc/free churn benchmark of N operations per run. Returns the process exit code.
+int run_alloc_bench(uint32_t ops);
+
+} // namespace vkmini
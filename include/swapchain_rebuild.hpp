@@ -0,0 +1,62 @@
+#pragma once
+#include "platform.hpp"
+#include <chrono>
+#include <cstdint>
+
+namespace vkmini {
+
+// When the render thread rebuilds its swapchain during and after a resize; --resize-replay checks
+// the same rule on synthetic events.
+//
+// The full rebuild (swapchain, depth buffer, framebuffers) waits for the resize to settle. Until
+// then, with live resize available, every size change rebuilds only the swapchain at the window's
+// size while the scene keeps rendering at its old size, blitted scaled into the swapchain images
+// (see ResizeBlitState); a presentation engine does not scale on its own, X11 Present copies the
+// image to the window's top-left corner unscaled. Without live resize the old swapchain keeps
+// presenting at its old size, and an out-of-date one, which cannot present at all (on XCB the
+// surface's currentExtent is the window size, so drivers may report it on every step), is rebuilt
+// at most once per debounce window with the frames in between skipped.
+class SwapchainRebuildPolicy {
+public:
+    using Clock = std::chrono::steady_clock;
+    enum class Action : uint8_t {
+        Render,
+        Rebuild, // full rebuild at the window's size
+        Resize,  // swapchain only, scene scaled into it (live resize)
+        Wait,    // skip the frame: nothing can be presented yet
+    };
+
+    // What the acquires and presents have reported since the last rebuild or resize.
+    struct Swapchain {
+        FramebufferSize built;   // window size it was built for
+        bool scaled = false;     // a live resize is in progress
+        bool suboptimal = false;
+        bool outOfDate = false;
+    };
+
+    SwapchainRebuildPolicy(std::chrono::milliseconds debounce, bool liveResize)
+        : debounce_(debounce), liveResize_(liveResize) {}
+
+    Action decide(FramebufferSize window, bool settled, const Swapchain& sc, Clock::time_point now) const
+    {
+        if (settled)
+            return sc.outOfDate || sc.suboptimal || sc.scaled || !(window == sc.built) ? Action::Rebuild : Action::Render;
+        if (liveResize_)
+            return sc.outOfDate || !(window == sc.built) ? Action::Resize : Action::Render;
+        if (sc.outOfDate) return now >= nextEarly_ ? Action::Rebuild : Action::Wait;
+        return Action::Render;
+    }
+
+    // Call after every rebuild or resize.
+    void rebuilt(Clock::time_point now) { nextEarly_ = now + debounce_; }
+
+    // With Action::Wait: when the out-of-date swapchain may be rebuilt.
+    Clock::time_point next_early_rebuild() const { return nextEarly_; }
+
+private:
+    std::chrono::milliseconds debounce_;
+    bool liveResize_;
+    Clock::time_point nextEarly_{};
+};
+
+} // namespace vkmini
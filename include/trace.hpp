@@ -0,0 +1,99 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// CPU instrumentation: scoped zones and counters recorded into per-thread lock-free rings while a
+// trace::Session is open, drained by a background thread and written as Chrome trace JSON
+// (chrome://tracing, Perfetto).
+//
+// With no session open a zone costs one relaxed atomic load; while recording, two clock reads and
+// one ring push. A thread's ring is allocated with its first event, so threads that never record
+// cost nothing, and freed when the thread exits. Configure with -DVKMINI_ENABLE_TRACE=OFF to
+// compile the macros out entirely.
+//
+//   VKMINI_TRACE_THREAD_NAME("streaming");
+//   VKMINI_TRACE_ZONE("setup_device");
+//   VKMINI_TRACE_COUNTER("wait semaphores", waitSems.size());
+//
+// Names must be string literals (or otherwise outlive the session).
+
+namespace vkmini::trace {
+
+bool active();
+
+inline uint64_t now_ns()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Labels the calling thread in the trace. Only remembered until the thread records its first event.
+void set_thread_name(const char* name);
+
+// A timeline that is not a thread (e.g. a GPU queue). Fed by one thread at a time; lives until exit,
+// so create it when it is first needed (with a session open).
+class Track;
+Track* track(const char* name);
+void zone(Track* t, const char* name, uint64_t beginNs, uint64_t endNs);
+
+void counter(const char* name, int64_t value);
+
+// Internal: appends a complete zone to the calling thread's ring.
+void emit_zone(const char* name, uint64_t beginNs, uint64_t endNs);
+
+class Zone {
+public:
+    explicit Zone(const char* name) : name_(active() ? name : nullptr)
+    {
+        if (name_) begin_ = now_ns();
+    }
+    ~Zone() { if (name_) emit_zone(name_, begin_, now_ns()); }
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+private:
+    const char* name_;
+    uint64_t begin_ = 0;
+};
+
+// Records from construction to destruction and writes the trace to `path` when destroyed.
+// An empty path makes it a no-op. One session at a time.
+class Session {
+public:
+    explicit Session(std::string path);
+    ~Session();
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+private:
+    std::string path_;
+};
+
+} // namespace vkmini::trace
+
+namespace vkmini {
+
+// --trace-bench N: CPU-only cost of a zone with and without a session open, plus self-checks of the
+// rings (N zones wrapping a drained ring without loss, drops counted on a full one) and of the
+// names' escaping in the written JSON. Returns the process exit code.
+int run_trace_bench(uint32_t zones);
+
+} // namespace vkmini
+
+#ifndef VKMINI_ENABLE_TRACE
+    #define VKMINI_ENABLE_TRACE 1
+#endif
+
+#if VKMINI_ENABLE_TRACE
+    #define VKMINI_TRACE_CONCAT_(a, b) a##b
+    #define VKMINI_TRACE_CONCAT(a, b) VKMINI_TRACE_CONCAT_(a, b)
+    #define VKMINI_TRACE_THREAD_NAME(name) ::vkmini::trace::set_thread_name(name)
+    #define VKMINI_TRACE_ZONE(name) ::vkmini::trace::Zone VKMINI_TRACE_CONCAT(vkminiTraceZone_, __LINE__){ name }
+    #define VKMINI_TRACE_COUNTER(name, value) \
+        do { if (::vkmini::trace::active()) ::vkmini::trace::counter((name), (int64_t)(value)); } while (0)
+#else
+    #define VKMINI_TRACE_THREAD_NAME(name) ((void)0)
+    #define VKMINI_TRACE_ZONE(name) ((void)0)
+    #define VKMINI_TRACE_COUNTER(name, value) ((void)0)
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+#include "suballocator.hpp"
+#include <vulkan/vulkan.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vkmini {
+
+class DeviceAllocator;
+
+// Move-only handle to a sub-allocated range; returns the range to its block on destruction.
+class Allocation {
+public:
+    Allocation() = default;
+    Allocation(DeviceAllocator* owner, uint32_t memType, uint32_t block, vk::DeviceMemory mem,
+               vk::DeviceSize offset, vk::DeviceSize size, std::byte* mapped)
+        : owner_(owner), memType_(memType), block_(block), mem_(mem), offset_(offset), size_(size), mapped_(mapped) {}
+    Allocation(Allocation&& o) noexcept { *this = std::move(o); }
+    Allocation& operator=(Allocation&& o) noexcept;
+    Allocation(const Allocation&) = delete;
+    Allocation& operator=(const Allocation&) = delete;
+    ~Allocation() { reset(); }
+
+    void reset() noexcept;
+
+    vk::DeviceMemory memory() const { return mem_; }
+    vk::DeviceSize offset() const { return offset_; }
+    vk::DeviceSize size() const { return size_; }
+    // Non-null for host-visible memory; blocks stay mapped for their whole lifetime.
+    void* mapped() const { return mapped_; }
+    explicit operator bool() const { return owner_ != nullptr; }
+
+private:
+    DeviceAllocator* owner_ = nullptr;
+    uint32_t memType_ = 0;
+    uint32_t block_ = 0;
+    vk::DeviceMemory mem_{};
+    vk::DeviceSize offset_ = 0;
+    vk::DeviceSize size_ = 0;
+    std::byte* mapped_ = nullptr;
+};
+
+struct HeapStats {
+    uint32_t blocks = 0;
+    uint32_t allocations = 0;
+    vk::DeviceSize reserved = 0;    // bytes held in vk::DeviceMemory blocks
+    vk::DeviceSize used = 0;        // bytes handed out to resources
+    vk::DeviceSize largestFree = 0;
+    // 0 when all free space is one contiguous range, approaching 1 as it splinters.
+    float fragmentation = 0.0f;
+};
+
+// Block allocator, one block list per memory type. Requests larger than half a block get a
+// dedicated vk::DeviceMemory. Thread-safe.
+class DeviceAllocator {
+public:
+    static constexpr vk::DeviceSize kDefaultBlockSize = 64ull * 1024 * 1024;
+
+    void init(vk::PhysicalDevice pd, vk::Device dev, vk::DeviceSize blockSize = kDefaultBlockSize);
+
+    Allocation allocate(const vk::MemoryRequirements& req, vk::MemoryPropertyFlags props, ResourceKind kind);
+
+    // Indexed by memory heap.
+    std::vector<HeapStats> stats() const;
+    std::string format_stats() const;
+
+    vk::Device device() const { return dev_; }
+
+private:
+    friend class Allocation;
+
+    struct Block {
+        vk::UniqueDeviceMemory mem;
+        BlockSuballocator policy;
+        std::byte* mapped = nullptr;
+        bool dedicated = false;
+    };
+
+    // Logs and ignores a range its block does not know, instead of throwing out of a destructor.
+    void free(uint32_t memType, uint32_t block, vk::DeviceSize offset) noexcept;
+    uint32_t find_mem_type(uint32_t typeBits, vk::MemoryPropertyFlags props) const;
+    uint32_t add_block(uint32_t memType, vk::DeviceSize size, bool dedicated);
+
+    vk::Device dev_{};
+    vk::PhysicalDeviceMemoryProperties memProps_{};
+    vk::DeviceSize granularity_ = 1;
+    vk::DeviceSize blockSize_ = kDefaultBlockSize;
+    uint32_t maxAllocations_ = 0;
+    uint32_t liveAllocations_ = 0; // vk::DeviceMemory objects, not sub-allocations
+
+    mutable std::mutex mutex_;
+    // Freed blocks leave a null slot so block indices held by Allocations stay valid.
+    std::array<std::vector<std::unique_ptr<Block>>, VK_MAX_MEMORY_TYPES> blocks_;
+};
+
+} // namespace vkmini
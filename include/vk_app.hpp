@@ -1,11 +1,15 @@
 #pragma once
 #include "platform.hpp"
+#include "app_options.hpp"
 
 namespace vkmini {
 
 class VkApp {
 public:
-    void run(IPlatformWindow& window);
+    // Both return the process exit code (non-zero when a --bench-compare run regressed).
+    int run(IPlatformWindow& window, const AppOptions& opts = {});
+    // Renders opts.frames frames offscreen; needs no window, surface or present support.
+    int run_headless(const AppOptions& opts);
 };
 
 } // namespace vkmini
@@ -4,7 +4,7 @@
 
 namespace vkmini {
 
-// Chooses a "best" device for the given surface.
+// Chooses a "best" device for the given surface (null surface: headless, no present support needed).
 // Security note: device selection is *policy*; ship games should typically pin a known-good device or verify driver versions.
 vk::PhysicalDevice pick_best_device(const std::vector<vk::PhysicalDevice>& devices, vk::SurfaceKHR surface);
 
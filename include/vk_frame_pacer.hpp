@@ -0,0 +1,77 @@
+#pragma once
+#include <vulkan/vulkan.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vkmini {
+
+// Frame pacing on one timeline semaphore: frame N's submit signals value N, and a frame slot (its
+// ring slices, command buffers, query pool, acquire semaphore) is reused once the value of the
+// frame that last used it has been reached. Replaces per-frame fences and the fence aliasing
+// per swapchain image: anything tagged with a value is retired by waiting for that value.
+// Objects still referenced by submitted frames (a resized swapchain's images, views, depth
+// buffer) are handed to defer() and destroyed once those frames retire, without a waitIdle.
+//
+// Also measures how well the CPU and GPU overlap: how many frames the GPU still had queued when the
+// CPU started the next one, how often it had none (GPU starved, CPU-bound), and how much of the
+// frame the CPU spent blocked on the GPU (GPU-bound).
+class FramePacer {
+public:
+    // Needs the timelineSemaphore feature; `khr` selects the VK_KHR_timeline_semaphore entry points.
+    void init(vk::Device dev, uint32_t framesInFlight, bool khr);
+
+    uint32_t frames() const { return frames_; }
+    // Slot of the frame being recorded.
+    uint32_t frame() const { return frame_; }
+    vk::Semaphore timeline() const { return timeline_.get(); }
+    // Value the frame being recorded signals when its submit completes.
+    uint64_t frame_value() const { return submitted_ + 1; }
+    // Value of the last submitted frame (0 before the first).
+    uint64_t submitted() const { return submitted_; }
+
+    // Top of the frame: blocks until the slot's previous frame has retired, and samples the overlap.
+    void begin_frame();
+    // Blocks until `value` has been reached; 0 returns at once.
+    void wait(uint64_t value);
+    // After the frame's submit (which signals frame_value()): tags the slot and moves to the next.
+    void end_frame();
+    // Highest value the GPU has completed.
+    uint64_t completed() const;
+
+    // Keeps `obj` alive until frame `value` has retired; begin_frame() destroys what is due, the
+    // pacer's destructor the rest (after the caller's waitIdle).
+    template<class T> void defer(uint64_t value, T obj)
+    {
+        deferred_.push_back({ value, std::make_shared<T>(std::move(obj)) });
+    }
+    // Same, for everything submitted so far.
+    template<class T> void defer(T obj) { defer(submitted_, std::move(obj)); }
+
+    std::string format_summary() const;
+
+private:
+    vk::Device dev_{};
+    vk::UniqueSemaphore timeline_;
+    PFN_vkWaitSemaphores waitSemaphores_ = nullptr;
+    PFN_vkGetSemaphoreCounterValue counterValue_ = nullptr;
+
+    uint32_t frames_ = 0, frame_ = 0;
+    uint64_t submitted_ = 0;
+    std::vector<uint64_t> slotValue_; // per slot: the frame that last used it
+
+    struct Deferred {
+        uint64_t value;
+        std::shared_ptr<void> obj; // type-erased owner: destroying it runs T's destructor
+    };
+    std::vector<Deferred> deferred_;
+
+    // Overlap statistics
+    std::chrono::steady_clock::time_point lastBegin_{};
+    uint64_t sampled_ = 0, starved_ = 0, queued_ = 0;
+    double stalledMs_ = 0, frameMs_ = 0;
+};
+
+} // namespace vkmini
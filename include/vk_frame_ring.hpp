@@ -0,0 +1,35 @@
+#pragma once
+#include "vk_helpers.hpp"
+#include <vulkan/vulkan.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace vkmini {
+
+// Host-visible buffer mapped once at creation and split into one slice per frame in flight.
+// Each frame bump-allocates from its own slice, so the CPU never writes memory the GPU may
+// still be reading for an older frame (as long as frame_ring_begin follows that frame's timeline wait).
+struct FrameRing {
+    Buffer buffer;
+    std::byte* mapped = nullptr;
+    vk::DeviceSize alignment = 1;   // min offset alignment for the ring's descriptor type(s)
+    vk::DeviceSize frameStride = 0; // bytes reserved per frame
+    uint32_t frames = 0;
+    uint32_t frame = 0;
+    vk::DeviceSize head = 0;        // next free byte within the current frame's slice
+};
+
+struct FrameRingSlice {
+    void* ptr = nullptr;
+    uint32_t offset = 0; // from buffer start; pass as the dynamic descriptor offset
+};
+
+FrameRing create_frame_ring(vk::PhysicalDevice pd, DeviceAllocator& alloc, vk::DeviceSize bytesPerFrame, uint32_t frames, vk::BufferUsageFlags usage);
+
+// Rewinds the slice owned by `frame`. Call once per frame, after that frame's timeline wait.
+void frame_ring_begin(FrameRing& r, uint32_t frame);
+
+// Throws when the current frame's slice is exhausted.
+FrameRingSlice frame_ring_alloc(FrameRing& r, vk::DeviceSize bytes);
+
+} // namespace vkmini
@@ -0,0 +1,85 @@
+#pragma once
+#include "trace.hpp"
+#include <vulkan/vulkan.hpp>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vkmini {
+
+// GPU timestamp zones plus one pipeline statistics query per frame, with one query pool per frame
+// in flight. A slot's results are read in begin_frame(), right after that frame's timeline wait, so
+// they are always complete and reading them never stalls. Zone names must be string literals.
+//
+// Timestamps are mapped onto the steady_clock timeline with a one-off calibration at init and, while
+// a trace::Session is recording, emitted on a "GPU graphics queue" track, so they line up with the
+// CPU zones to within the calibration submit's latency.
+class GpuProfiler {
+public:
+    static constexpr uint32_t kMaxZones = 32; // per frame
+
+    // Pipeline statistics of the most recently resolved frame (zeros if unsupported).
+    struct PipelineStats {
+        uint64_t iaVertices = 0, iaPrimitives = 0, vsInvocations = 0;
+        uint64_t clipInvocations = 0, clipPrimitives = 0, fsInvocations = 0;
+    };
+
+    // Leaves the profiler disabled (every call a no-op) if the queue family has no timestamp support.
+    // pipelineStats requires the pipelineStatisticsQuery device feature to be enabled.
+    void init(vk::PhysicalDevice pd, vk::Device dev, vk::Queue queue, uint32_t queueFamily,
+              uint32_t frames, bool pipelineStats);
+    bool enabled() const { return enabled_; }
+
+    // After frame `frame`'s timeline wait, at the start of its command buffer (outside a render pass):
+    // resolves what the slot recorded last time and resets its queries.
+    void begin_frame(uint32_t frame, vk::CommandBuffer cb);
+
+    // Returns a zone index for end_zone, or ~0u if disabled or out of zones.
+    uint32_t begin_zone(vk::CommandBuffer cb, const char* name);
+    void end_zone(vk::CommandBuffer cb, uint32_t zone);
+
+    // Pipeline statistics around the frame's draws; both calls outside a render pass.
+    void begin_stats(vk::CommandBuffer cb);
+    void end_stats(vk::CommandBuffer cb);
+    // For the inheritance info of secondaries executed while the statistics query is active
+    // (requires the inheritedQueries device feature); empty when statistics are off.
+    vk::QueryPipelineStatisticFlags inherited_statistics() const;
+
+    // After the device is idle: resolves the slots still holding unread results.
+    void finish();
+
+    const PipelineStats& pipeline_stats() const { return stats_; }
+    // Mean GPU time per zone name over every resolved frame.
+    std::string format_summary() const;
+
+private:
+    struct Slot {
+        vk::UniqueQueryPool timestamps;
+        vk::UniqueQueryPool statistics;
+        std::array<const char*, kMaxZones> names{};
+        uint32_t zones = 0;
+        bool statsWritten = false;
+        bool pending = false;
+    };
+    struct Total { const char* name; double ns; uint32_t count; };
+
+    void calibrate(vk::Queue queue, uint32_t queueFamily);
+    void resolve(Slot& slot);
+    uint64_t to_ns(uint64_t ticks) const;
+
+    bool enabled_ = false;
+    vk::Device dev_{};
+    double nsPerTick_ = 1.0;
+    uint64_t tickMask_ = ~0ull;
+    uint64_t gpuEpoch_ = 0;   // ticks at the calibration point
+    uint64_t cpuEpochNs_ = 0; // steady_clock nanoseconds at the same point
+    trace::Track* track_ = nullptr; // created with the first zone traced, not at init
+
+    std::vector<Slot> slots_;
+    uint32_t current_ = 0;
+    PipelineStats stats_{};
+    std::vector<Total> totals_;
+};
+
+} // namespace vkmini
@@ -1,32 +1,37 @@
 #pragma once
+#include "vk_allocator.hpp"
 #include <vulkan/vulkan.hpp>
 #include <cstdint>
+#include <optional>
 #include <vector>
 
 namespace vkmini {
 
 uint32_t pick_graphics_qf(vk::PhysicalDevice pd);
 uint32_t pick_present_qf(vk::PhysicalDevice pd, vk::SurfaceKHR surface);
+// Transfer-capable family without graphics (preferring one without compute too), i.e. a DMA queue.
+std::optional<uint32_t> pick_transfer_qf(vk::PhysicalDevice pd);
+bool has_device_extension(vk::PhysicalDevice pd, const char* name);
 
 vk::SurfaceFormatKHR pick_surface_format(const std::vector<vk::SurfaceFormatKHR>& formats);
 vk::PresentModeKHR pick_present_mode(const std::vector<vk::PresentModeKHR>& modes);
+// `requested` (--swapchain-images) clamped to what the surface allows; 0 picks max(2, minImageCount).
+uint32_t pick_image_count(const vk::SurfaceCapabilitiesKHR& caps, uint32_t requested);
 vk::Format find_depth_format(vk::PhysicalDevice pd);
 
+// Memory is sub-allocated from the DeviceAllocator's blocks; host-visible ranges are
+// already mapped (mem.mapped()).
 struct Buffer {
     vk::UniqueBuffer buf;
-    vk::UniqueDeviceMemory mem;
+    Allocation mem;
 };
 
 struct Image {
     vk::UniqueImage img;
-    vk::UniqueDeviceMemory mem;
+    Allocation mem;
 };
 
-Buffer create_buffer(vk::PhysicalDevice pd, vk::Device dev, vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags props);
-Image  create_image(vk::PhysicalDevice pd, vk::Device dev, uint32_t w, uint32_t h, vk::Format fmt, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags props);
-
-void copy_buffer(vk::Device dev, vk::Queue q, vk::CommandPool pool, vk::Buffer src, vk::Buffer dst, vk::DeviceSize size);
-void transition_image_layout(vk::Device dev, vk::Queue q, vk::CommandPool pool, vk::Image image, vk::Format fmt, vk::ImageLayout oldL, vk::ImageLayout newL);
-void copy_buffer_to_image(vk::Device dev, vk::Queue q, vk::CommandPool pool, vk::Buffer src, vk::Image dst, uint32_t w, uint32_t h);
+Buffer create_buffer(DeviceAllocator& alloc, vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags props);
+Image  create_image(DeviceAllocator& alloc, uint32_t w, uint32_t h, vk::Format fmt, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags props);
 
 } // namespace vkmini
@@ -4,15 +4,41 @@
 
 namespace vkmini {
 
-// setup entrypoint used by VkApp
-void setup(AppState& s, IPlatformWindow& wnd);
+// setup entrypoint used by VkApp; wnd is null for headless (offscreen targets, no surface)
+void setup(AppState& s, IPlatformWindow* wnd);
 
-// reusable pieces for swapchain recreation
-void setup_pipeline(AppState& s);
-void create_framebuffers(AppState& s);
-void create_cmd_buffers(AppState& s);
+void create_offscreen_targets(AppState& s);
 
-// main loop
+// Rebuilds the swapchain and everything sized after it for framebuffer size fb (non-zero), handing
+// the old swapchain to the new one; the old objects are destroyed once the frames using them have
+// retired. Touches no window, so it runs on the render thread.
+void recreate_swapchain(AppState& s, FramebufferSize fb);
+// Live resize (s.blit.supported): rebuilds only the swapchain and its per-image objects for fb and
+// keeps rendering the scene at the size it had when the first step began, blitted scaled into the
+// swapchain images (see ResizeBlitState). recreate_swapchain() ends it.
+void resize_swapchain_scaled(AppState& s, FramebufferSize fb);
+
+// per-frame pieces shared by the windowed and headless loops
+inline constexpr float kBenchTimestep = 1.0f / 60.0f; // headless and --bench animation step, seconds
+// Dynamic offsets of this frame's ring slices, in descriptor binding order, and the draw's size.
+struct FrameOffsets {
+    uint32_t ubo = 0;
+    uint32_t instances = 0; // with --gpu-cull, this frame's slice of the compacted buffer
+    uint32_t cull = 0;      // --gpu-cull: CullUBO slice in the uniform ring
+    uint32_t cullArgs = 0;  // --gpu-cull: this frame's CullArgs slice
+    uint32_t instanceCount = 0; // instances written (the visible ones with --cpu-cull)
+};
+// Writes this frame's UBO and instance transforms into their rings and returns the offsets.
+FrameOffsets update_uniforms(AppState& s, uint32_t frame, float seconds);
+// --stream-texture: call after the frame's streaming acquire. Switches to the texture copy whose
+// upload has just been acquired, and queues the next upload into the copy no frame in flight samples.
+void stream_texture(AppState& s);
+// Clears and draws the scene into target imageIndex, leaving it in s.sc.finalLayout. With
+// --record-threads the draws are recorded into frame `frame`'s secondaries and executed from cb.
+void record_scene(AppState& s, vk::CommandBuffer cb, uint32_t frame, uint32_t imageIndex, const FrameOffsets& offsets);
+
+// main loops
 void run_loop(AppState& s, IPlatformWindow& wnd);
+void run_headless(AppState& s);
 
 } // namespace vkmini
@@ -0,0 +1,54 @@
+#pragma once
+#include <vulkan/vulkan.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace vkmini {
+
+struct PipelineCacheStats {
+    uint32_t created = 0;
+    uint32_t hits = 0;     // driver reported the pipeline came out of the cache
+    uint32_t misses = 0;   // compiled from scratch (or unknown, without creation feedback)
+    double hitMs = 0.0;    // total creation time, split by outcome
+    double missMs = 0.0;
+};
+
+// vk::PipelineCache backed by a file. load() seeds the cache from disk if the blob's header
+// matches this device (vendorID, deviceID, pipelineCacheUUID); anything else is discarded and
+// the cache starts empty. save() writes the merged cache back through a temporary file and a
+// rename, so an interrupted write never leaves a truncated blob behind.
+//
+// With VK_EXT_pipeline_creation_feedback enabled, create_graphics()/create_compute() report true
+// hits and misses; otherwise every creation counts as a miss and only the timing is meaningful.
+class PipelineCache {
+public:
+    // VKMINI_PIPELINE_CACHE if set, else vkmini_pipeline_cache.bin in the working directory.
+    static std::filesystem::path default_path();
+
+    void load(vk::PhysicalDevice pd, vk::Device dev, std::filesystem::path path, bool creationFeedback);
+    // Writes the cache back if any pipeline was compiled since load(). Returns false on I/O failure.
+    bool save();
+    void reset() { cache_.reset(); }
+
+    vk::UniquePipeline create_graphics(const vk::GraphicsPipelineCreateInfo& ci, const char* name);
+    vk::UniquePipeline create_compute(const vk::ComputePipelineCreateInfo& ci, const char* name);
+
+    vk::PipelineCache get() const { return cache_.get(); }
+    const PipelineCacheStats& stats() const { return stats_; }
+    std::string format_stats() const;
+
+private:
+    template <class CreateInfo, class Create>
+    vk::UniquePipeline create_with_feedback(const CreateInfo& ci, const char* name, Create&& create);
+
+    vk::Device dev_{};
+    vk::PhysicalDeviceProperties props_{};
+    vk::UniquePipelineCache cache_;
+    std::filesystem::path path_;
+    bool feedback_ = false;
+    bool dirty_ = false;
+    PipelineCacheStats stats_{};
+};
+
+} // namespace vkmini
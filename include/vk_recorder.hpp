@@ -0,0 +1,45 @@
+#pragma once
+#include "jobs.hpp"
+#include <vulkan/vulkan.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace vkmini {
+
+// Records a frame's draw list into secondary command buffers as jobs on the shared JobSystem. Each
+// slice of the list owns one transient command pool per frame in flight holding a single secondary
+// buffer, so whichever thread records a slice takes no locks, and a frame's pools are reset
+// wholesale when that frame comes round again instead of resetting buffers one by one.
+//
+// The list is split into up to `slices` contiguous slices; short lists use fewer.
+class ParallelRecorder {
+public:
+    // Records draws [begin, end) into cb, which is already begun with the frame's inheritance.
+    // Called concurrently from the job threads.
+    using RecordFn = std::function<void(vk::CommandBuffer cb, uint32_t begin, uint32_t end)>;
+
+    void start(vk::Device dev, uint32_t queueFamily, uint32_t slices, uint32_t frames, JobSystem& jobs);
+
+    bool enabled() const { return slices_ != 0; }
+    uint32_t slices() const { return slices_; }
+
+    // Render thread, after frame `frame`'s timeline wait. Returns the recorded secondaries in draw
+    // order (empty for an empty list), valid until the next call. Rethrows a slice's exception.
+    const std::vector<vk::CommandBuffer>& record(uint32_t frame, const vk::CommandBufferInheritanceInfo& inheritance,
+                                                 uint32_t drawCount, const RecordFn& fn);
+
+private:
+    struct Slot {
+        vk::UniqueCommandPool pool;
+        vk::CommandBuffer cb; // freed with the pool
+    };
+
+    vk::Device dev_{};
+    JobSystem* jobs_ = nullptr;
+    uint32_t slices_ = 0, frames_ = 0;
+    std::vector<Slot> slots_; // [slice * frames + frame]
+    std::vector<vk::CommandBuffer> recorded_;
+};
+
+} // namespace vkmini
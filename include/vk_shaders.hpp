@@ -0,0 +1,22 @@
+#pragma once
+#include <vulkan/vulkan.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace vkmini {
+
+enum class ShaderId { CubeVert, CubeFrag, CullComp };
+
+// Module for a shader in shaders/. By default its SPIR-V is compiled by glslc at build time and
+// embedded in the binary. With VKMINI_RUNTIME_SHADERC (dev mode) the GLSL is re-read from the
+// source tree and compiled on every call, so shader edits apply on the next pipeline rebuild.
+// Thread-safe.
+vk::UniqueShaderModule create_shader_module(vk::Device dev, ShaderId id);
+
+// The two halves of the above, so the SPIR-V (the slow part in dev mode) can be prepared before
+// the device exists. Both thread-safe.
+std::vector<uint32_t> load_shader_spirv(ShaderId id);
+vk::UniqueShaderModule create_shader_module(vk::Device dev, std::span<const uint32_t> spirv);
+
+} // namespace vkmini
@@ -2,6 +2,20 @@
 
 #include "vk_platform.hpp" // must be before Vulkan-Hpp
 #include <vulkan/vulkan.hpp>
+#include "app_options.hpp"
+#include "bench.hpp"
+#include "vk_allocator.hpp"
+#include "vk_frame_ring.hpp"
+#include "vk_pipeline_cache.hpp"
+#include "vk_gpu_profiler.hpp"
+#include "vk_upload.hpp"
+#include "vk_streaming.hpp"
+#include "vk_recorder.hpp"
+#include "vk_frame_pacer.hpp"
+#include "cull.hpp"
+#include "jobs.hpp"
+#include "startup.hpp"
+#include <memory>
 #include <vector>
 #include <array>
 #include <cstdint>
@@ -9,78 +23,196 @@
 namespace vkmini {
 
 struct Vertex { float px,py,pz; float u,v; };
-struct UBO { float mvp[16]; };
+inline constexpr uint32_t kCubeIndexCount = 36; // 16-bit indices into 24 vertices
+struct UBO { float viewProj[16]; };
+// std140 layout of cull.comp's Cull block.
+struct CullUBO { float spin[16]; float planes[6][4]; uint32_t count; uint32_t pad[3]; };
+// cull.comp's Args block: one indexed indirect draw followed by the draw count.
+struct CullArgs { vk::DrawIndexedIndirectCommand draw; uint32_t drawCount; };
+inline constexpr uint32_t kCullGroupSize = 64; // cull.comp's local_size_x
 
 struct SwapchainState {
     vk::UniqueSwapchainKHR swapchain;
     vk::SurfaceFormatKHR   surfFmt{};
     vk::PresentModeKHR     presentMode{};
     vk::Extent2D           extent{};
+    // Window framebuffer size the swapchain was built for, and what its acquires and presents have
+    // reported since; see SwapchainRebuildPolicy for when each one rebuilds it.
+    vk::Extent2D           windowSize{};
+    bool                   suboptimal = false;
+    bool                   outOfDate = false;
     std::vector<vk::Image> images;
     std::vector<vk::UniqueImageView> views;
+    // Headless: one owned offscreen target per frame in flight stands in for the swapchain images,
+    // and rendering ends in TransferSrc (for readback) instead of PresentSrc.
+    std::vector<Image> offscreen;
+    vk::ImageLayout finalLayout = vk::ImageLayout::ePresentSrcKHR;
 };
 
+// Live resize (see SwapchainRebuildPolicy): while a drag-resize is unsettled the swapchain follows
+// the window, but the scene keeps rendering at the size it had when the drag began, into `color`
+// with the depth buffer of that size, and each frame blits it, scaled with linear filtering, into
+// the acquired swapchain image. A step rebuilds only the swapchain and its per-image objects; the
+// settled rebuild resizes the rest once and goes back to drawing into the swapchain directly.
+// Needs transfer-dst swapchain images and a surface format that blits with linear filtering.
+struct ResizeBlitState {
+    bool supported = false;  // decided with the first swapchain
+    bool active = false;
+    vk::Extent2D extent{};   // scene size while active
+    vk::UniqueRenderPass renderPass; // render pass path: the scene pass, ending in TransferSrcOptimal
+    Image color;
+    vk::UniqueImageView view;
+    vk::UniqueFramebuffer framebuffer; // render pass path
+};
+
+// Frame slots are retired by the pacer's timeline; the binary semaphores only link acquire and
+// present to the frame's submit.
 struct SyncState {
-    static constexpr uint32_t kMaxFramesInFlight = 2;
-    std::array<vk::UniqueSemaphore, kMaxFramesInFlight> imageAvailable{};
-    std::array<vk::UniqueSemaphore, kMaxFramesInFlight> renderFinished{};
-    std::array<vk::UniqueFence,     kMaxFramesInFlight> frameFence{};
-    std::vector<vk::Fence> imagesInFlight;
-    uint32_t frameIndex = 0;
+    uint32_t framesInFlight = 2; // --frames-in-flight, fixed at setup
+    bool timelineKhr = false;    // VK_KHR_timeline_semaphore entry points (pre-1.2 device)
+    FramePacer pacer;
+    std::vector<vk::UniqueSemaphore> imageAvailable; // per frame slot
+    std::vector<vk::UniqueSemaphore> renderFinished; // per swapchain image: its last present may still wait on it
+    std::vector<uint64_t> imageValue; // per swapchain image: timeline value of the last frame that rendered to it
 };
 
+// Viewport and scissor are dynamic state, so the pipeline, its layout and the shader modules
+// survive resizes; only a surface format change (new render pass) rebuilds the pipeline.
 struct PipelineState {
     vk::UniqueRenderPass renderPass;
+    vk::UniqueShaderModule vert;
+    vk::UniqueShaderModule frag;
     vk::UniquePipelineLayout pipelineLayout;
     vk::UniquePipeline pipeline;
     std::vector<vk::UniqueFramebuffer> framebuffers;
 };
 
+// Chosen once at device creation. Dynamic rendering (VK_KHR_dynamic_rendering, core in 1.3) binds
+// the attachments at record time, so there is no render pass and no framebuffers; otherwise the
+// classic render pass path is used. The entry points are loaded from the device because the
+// static loader may not export them.
+struct RenderBackend {
+    bool dynamic = false;
+    PFN_vkCmdBeginRenderingKHR beginRendering = nullptr;
+    PFN_vkCmdEndRenderingKHR endRendering = nullptr;
+};
+
 struct DepthState {
     vk::Format depthFmt{};
     vk::UniqueImageView view;
     vk::UniqueImage img;
-    vk::UniqueDeviceMemory mem;
+    Allocation mem;
 };
 
 struct TextureState {
     vk::UniqueImage img;
-    vk::UniqueDeviceMemory mem;
+    Allocation mem;
     vk::UniqueImageView view;
     vk::UniqueSampler sampler;
 };
 
+// --stream-texture N: a second copy of the texture is rewritten on the transfer queue every N
+// frames while the frames sample the first, and the frames switch to it in the frame that records
+// its ownership acquire. Each copy has its own descriptor set, differing only in binding 1.
+struct TextureStream {
+    uint32_t period = 0;  // frames between uploads, 0 when off
+    TextureState tex;     // copy 1 (copy 0 is AppState::tex); no sampler of its own
+    vk::UniqueDescriptorSet dset;
+    uint32_t front = 0;   // copy the frames sample
+    std::array<uint64_t,2> lastUse{}; // per copy: timeline value of the last frame that sampled it
+    uint64_t pending = 0;    // streaming request id of the upload into the back copy, 0 when none
+    uint64_t nextUpload = 0; // frame value from which the next upload may start
+    uint32_t phase = 0;      // pattern offset of the last upload
+    uint64_t uploads = 0;    // completed and switched to
+};
+
 struct BufferState {
     vk::UniqueBuffer buf;
-    vk::UniqueDeviceMemory mem;
+    Allocation mem;
+};
+
+// Per-instance model matrices live in a mapped ring (binding 2, dynamic storage buffer) that is
+// rewritten every frame and indexed by gl_InstanceIndex, so any number of cubes is one draw.
+// The grid positions are fixed at setup. With --cpu-cull only the instances whose bounding
+// sphere survives the frustum test are written, compacted, and the draw shrinks to match.
+struct InstanceState {
+    uint32_t count = 1;
+    std::vector<std::array<float,3>> positions;
+    float sceneRadius = 0.0f; // bounding sphere of the cube centers, for camera placement
+    FrameRing transforms;
+
+    std::unique_ptr<CpuCuller> culler; // --cpu-cull
+    SphereSoA bounds;
+    std::vector<uint32_t> visible;
+};
+
+// --gpu-cull: a compute pass tests every instance's bounding sphere against the frustum and
+// writes the survivors' model matrices, compacted, into `visible` (graphics binding 2 in this
+// mode). The one indexed indirect draw takes its instanceCount from the pass, so the CPU cost per
+// frame no longer depends on the instance count. drawIndexedIndirectCount is used when the device
+// has it (core 1.2 feature or VK_KHR_draw_indirect_count), else plain drawIndexedIndirect.
+// `visible` and `args` hold one slice per frame in flight, selected with dynamic offsets.
+struct GpuCullState {
+    bool enabled = false;
+    PFN_vkCmdDrawIndexedIndirectCount drawIndexedIndirectCount = nullptr;
+    BufferState objects; // vec4 bounding sphere per instance, static
+    BufferState visible; // compacted model matrices
+    BufferState args;    // CullArgs
+    vk::DeviceSize visibleStride = 0; // bytes per frame slice, storage offset aligned
+    vk::DeviceSize argsStride = 0;
+    vk::UniqueShaderModule shader;
+    vk::UniqueDescriptorSetLayout dsl;
+    vk::UniqueDescriptorPool dpool;
+    vk::UniqueDescriptorSet dset;
+    vk::UniquePipelineLayout layout;
+    vk::UniquePipeline pipeline;
 };
 
 struct AppState {
+    AppOptions opts;
+    JobSystem jobs; // declared early so its workers outlive everything that schedules on them
+    BenchRecorder bench; // active with --bench
+    StartupReport startup;
     vk::UniqueInstance instance;
     vk::UniqueDevice device;
     vk::PhysicalDevice pd{};
-    vk::UniqueSurfaceKHR surface;
+    vk::UniqueSurfaceKHR surface; // null when headless
+    DeviceAllocator alloc; // declared before every resource so it outlives their Allocations
+    PipelineCache pipelineCache;
+    GpuProfiler gpu; // --gpu-profile; every call is a no-op when disabled
 
     vk::Queue graphicsQueue;
     vk::Queue presentQueue;
+    vk::Queue transferQueue; // may alias graphicsQueue, see StreamingUploader
     uint32_t graphicsQ = 0;
     uint32_t presentQ = 0;
+    uint32_t transferQ = 0;
 
     vk::UniqueCommandPool cmdPool;
+    UploadContext uploads;        // startup uploads, graphics queue
+    StreamingUploader streaming;  // mid-session uploads, transfer queue
     std::vector<vk::UniqueCommandBuffer> cmdBuffers;
+    ParallelRecorder recorder;    // --record-threads: the scene's draws go into secondaries
 
+    RenderBackend render;
     SwapchainState sc;
+    ResizeBlitState blit;
     DepthState depth;
     PipelineState pipe;
     SyncState sync;
 
     TextureState tex;
     BufferState vbo;
-    BufferState ubo;
+    BufferState ibo;
+    FrameRing ubo; // per-frame UBO slices, bound with a dynamic offset
+    InstanceState instances;
 
     vk::UniqueDescriptorSetLayout dsl;
     vk::UniqueDescriptorPool dpool;
     vk::UniqueDescriptorSet dset;
+
+    TextureStream texStream;
+    GpuCullState cull;
 };
 
 } // namespace vkmini
@@ -0,0 +1,93 @@
+#pragma once
+#include "vk_upload.hpp"
+#include <vulkan/vulkan.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkmini {
+
+// Mid-session uploads on a background thread. Batches are recorded and submitted on the transfer
+// queue, released to the graphics family, and handed to the render thread only once they have
+// completed, so acquiring them never stalls a frame.
+//
+// If the transfer queue is the graphics queue itself (no spare queue on the device), the render
+// thread must hold lock_shared_queue() around its own submits and presents.
+class StreamingUploader {
+public:
+    ~StreamingUploader() { stop(); }
+
+    void start(DeviceAllocator& alloc, vk::Queue transferQueue, uint32_t transferFamily,
+               uint32_t graphicsFamily, bool sharesGraphicsQueue);
+    // Joins the worker once the batches it submitted have completed, then drains the transfer
+    // queue. Requests not yet picked up are dropped: stopping is for shutdown, when the resources
+    // they target are about to go. Safe to call twice.
+    void stop();
+
+    // Thread-safe; the data is copied. Returns the request's id: ids increase by one per request,
+    // and the render thread may use the destination once acquired() has reached it.
+    uint64_t upload_buffer(vk::Buffer dst, vk::DeviceSize dstOffset, std::vector<std::byte> data);
+    uint64_t upload_image(vk::Image dst, uint32_t w, uint32_t h, std::vector<std::byte> data);
+
+    // Render thread. Call after frame `frame`'s timeline wait: recycles the semaphores it consumed.
+    void begin_frame(uint32_t frame);
+    // Render thread. Records ownership acquires for completed batches into cb (outside a render pass)
+    // and appends the semaphores the frame's submit has to wait on.
+    void acquire(uint32_t frame, vk::CommandBuffer cb,
+                 std::vector<vk::Semaphore>& waitSemaphores, std::vector<vk::PipelineStageFlags>& waitStages);
+    // Render thread. Id of the last request whose acquire has been recorded (0 before the first);
+    // batches complete in order, so every earlier request is usable too.
+    uint64_t acquired() const { return acquired_; }
+
+    // Held around any direct use of the transfer queue (e.g. device waitIdle).
+    std::unique_lock<std::mutex> lock_queue() { return std::unique_lock<std::mutex>(queueMutex_); }
+    std::unique_lock<std::mutex> lock_shared_queue()
+    {
+        return sharesGraphics_ ? std::unique_lock<std::mutex>(queueMutex_) : std::unique_lock<std::mutex>();
+    }
+    std::mutex* shared_queue_mutex() { return sharesGraphics_ ? &queueMutex_ : nullptr; }
+
+private:
+    struct Request {
+        vk::Buffer buffer{};
+        vk::DeviceSize offset = 0;
+        vk::Image image{};
+        uint32_t w = 0, h = 0;
+        std::vector<std::byte> data;
+        uint64_t id = 0;
+    };
+    struct Handoff {
+        UploadTicket ticket;
+        uint64_t lastRequest = 0; // id of the batch's last request
+        vk::UniqueSemaphore done;
+        UploadAcquire acquire;
+    };
+
+    void worker();
+    void process(std::deque<Handoff>& submitted);
+    vk::UniqueSemaphore take_semaphore();
+
+    vk::Device dev_{};
+    vk::Queue queue_{};
+    bool sharesGraphics_ = false;
+    std::mutex queueMutex_;
+    UploadContext ctx_; // worker thread only
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Request> requests_;
+    uint64_t lastRequest_ = 0;
+    std::vector<Handoff> ready_;               // completed, waiting for the render thread
+    std::vector<vk::UniqueSemaphore> freeSemaphores_;
+    bool stop_ = false;
+
+    std::vector<std::vector<vk::UniqueSemaphore>> frameSemaphores_; // render thread only
+    uint64_t acquired_ = 0;                                         // render thread only
+    std::thread thread_;
+};
+
+} // namespace vkmini
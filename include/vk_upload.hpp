@@ -0,0 +1,81 @@
+#pragma once
+#include "staging_ring.hpp"
+#include "vk_helpers.hpp"
+#include <vulkan/vulkan.hpp>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace vkmini {
+
+// Identifies one submitted upload batch. Tickets increase monotonically; completing a ticket
+// implies every earlier ticket has completed as well.
+struct UploadTicket { uint64_t value = 0; };
+
+// Ownership acquires matching the releases an UploadContext records when it uploads on behalf of
+// another queue family. Record them on the owning family's queue after waiting on the batch.
+struct UploadAcquire {
+    std::vector<vk::BufferMemoryBarrier> buffers;
+    std::vector<vk::ImageMemoryBarrier> images;
+    bool empty() const { return buffers.empty() && images.empty(); }
+};
+
+// Records any number of staged copies and layout transitions into a single command buffer and
+// submits them together. Source data is copied into a persistently mapped staging ring that is
+// recycled as batches retire; uploads larger than the ring get a temporary staging buffer.
+//
+// When ownerFamily names a different queue family, every upload ends in a queue family ownership
+// release (including the image's final layout transition) and the matching acquires are handed
+// out by submit(). queueMutex, if set, is held around queue submits for queues shared across threads.
+class UploadContext {
+public:
+    static constexpr vk::DeviceSize kDefaultStagingBytes = 16ull * 1024 * 1024;
+
+    void init(DeviceAllocator& alloc, vk::Queue queue, uint32_t queueFamily, vk::DeviceSize stagingBytes = kDefaultStagingBytes,
+              uint32_t ownerFamily = VK_QUEUE_FAMILY_IGNORED, std::mutex* queueMutex = nullptr);
+
+    void upload_buffer(vk::Buffer dst, vk::DeviceSize dstOffset, const void* data, vk::DeviceSize bytes);
+    // Transitions dst (single mip/layer, color) Undefined -> TransferDst -> finalLayout around the copy.
+    void upload_image(vk::Image dst, uint32_t w, uint32_t h, const void* data, vk::DeviceSize bytes,
+                      vk::ImageLayout finalLayout = vk::ImageLayout::eShaderReadOnlyOptimal);
+
+    // Submits everything recorded since the last submit. Returns the last ticket if nothing was recorded.
+    // `signal` is signaled when the batch (and every earlier one) completes. `acquire` receives the
+    // ownership acquires for all uploads released since the previous call that passed one.
+    UploadTicket submit(vk::Semaphore signal = {}, UploadAcquire* acquire = nullptr);
+    bool is_complete(UploadTicket t);
+    void wait(UploadTicket t);
+
+private:
+    struct Batch {
+        uint64_t ticket = 0;
+        vk::UniqueCommandBuffer cb;
+        vk::UniqueFence fence;
+        std::vector<Buffer> temps; // oversized staging buffers, freed on retire
+    };
+
+    bool releases() const { return ownerFamily_ != VK_QUEUE_FAMILY_IGNORED && ownerFamily_ != family_; }
+    vk::CommandBuffer recording();
+    vk::DeviceSize stage(const void* data, vk::DeviceSize bytes, vk::Buffer& src);
+    void retire(bool block);
+
+    DeviceAllocator* alloc_ = nullptr;
+    vk::Device dev_{};
+    vk::Queue queue_{};
+    uint32_t family_ = 0;
+    uint32_t ownerFamily_ = VK_QUEUE_FAMILY_IGNORED;
+    std::mutex* queueMutex_ = nullptr;
+    vk::UniqueCommandPool pool_;
+    Buffer staging_;
+
+    Batch open_;                        // batch currently being recorded (cb null if none)
+    std::deque<Batch> inFlight_;        // submitted, oldest first
+    StagingRing ring_;                  // ranges of staging_ in use, by batch
+    UploadAcquire release_;             // releases for the open batch, recorded at submit
+    UploadAcquire acquire_;             // acquires not yet handed out
+    uint64_t nextTicket_ = 1;
+    uint64_t completed_ = 0;
+};
+
+} // namespace vkmini
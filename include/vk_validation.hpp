@@ -1,5 +1,8 @@
 #pragma once
+#include "debug_sink.hpp"
 #include <vulkan/vulkan.hpp>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace vkmini {
@@ -11,6 +14,7 @@ struct ValidationConfig {
 };
 
 ValidationConfig make_validation_config();
+// Counts the message and queues it for the debug log's writer thread; never blocks on output.
 VkBool32 VKAPI_CALL debug_callback(
     VkDebugUtilsMessageSeverityFlagBitsEXT,
     VkDebugUtilsMessageTypeFlagsEXT,
@@ -24,4 +28,8 @@ struct DebugMessenger {
 
 DebugMessenger create_debug_messenger(vk::Instance instance);
 
+// Both wait until the queued messages have been written.
+DebugMessageStats debug_message_stats();
+std::string format_debug_message_stats(); // empty when there were no messages
+
 } // namespace vkmini
@@ -0,0 +1,76 @@
+#pragma once
+#include "platform.hpp"
+#include "spsc_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace vkmini {
+
+// Window state the render thread acts on. Published whole, so the render thread never sees the
+// size of one pump with the flags of another.
+struct WindowSnapshot {
+    FramebufferSize size;
+    bool minimized = false;
+    bool settled = true; // IPlatformWindow::resize_settled()
+    bool quit = false;
+
+    bool operator==(const WindowSnapshot&) const = default;
+};
+
+// What changed between two pumps, stamped when the event thread noticed it.
+struct WindowEvent {
+    enum class Type : uint8_t { Resize, ResizeSettled, Minimize, Restore, Quit };
+    Type type = Type::Resize;
+    FramebufferSize size;
+    std::chrono::steady_clock::time_point time;
+};
+
+// Hand-off from the thread that owns the window (and pumps its events) to the render thread.
+// Transitions go through a lock-free queue, in order and timestamped; the latest state is one
+// atomic word, so the render thread reads it without a lock and can block on it while minimized.
+// A full queue drops events, never state.
+class WindowChannel {
+public:
+    static constexpr uint32_t kMaxExtent = (1u << 30) - 1; // per side, 30 bits in the packed word
+
+    // Event thread.
+    void publish(const WindowSnapshot& w)
+    {
+        state_.store(pack(w), std::memory_order_release);
+        state_.notify_all();
+    }
+    bool push(const WindowEvent& e)
+    {
+        if (events_.push(e)) return true;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Render thread.
+    WindowSnapshot latest() const { return unpack(state_.load(std::memory_order_acquire)); }
+    bool pop(WindowEvent& e) { return events_.pop(e); }
+    // Blocks until the event thread publishes a state other than `seen`.
+    void wait_change(const WindowSnapshot& seen) const { state_.wait(pack(seen), std::memory_order_acquire); }
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    static uint64_t pack(const WindowSnapshot& w)
+    {
+        return uint64_t(std::min(w.size.w, kMaxExtent)) | uint64_t(std::min(w.size.h, kMaxExtent)) << 30
+             | uint64_t(w.minimized) << 60 | uint64_t(w.settled) << 61 | uint64_t(w.quit) << 62;
+    }
+    static WindowSnapshot unpack(uint64_t v)
+    {
+        return WindowSnapshot{ FramebufferSize{ uint32_t(v & kMaxExtent), uint32_t(v >> 30 & kMaxExtent) },
+                               bool(v >> 60 & 1), bool(v >> 61 & 1), bool(v >> 62 & 1) };
+    }
+
+    SpscQueue<WindowEvent, 256> events_;
+    std::atomic<uint64_t> state_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace vkmini
@@ -0,0 +1,7 @@
+#version 450
+layout(location=0) in vec2 vUV;
+layout(location=0) out vec4 outColor;
+layout(binding=1) uniform sampler2D texSampler;
+void main() {
+    outColor = texture(texSampler, vUV);
+}
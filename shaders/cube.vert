@@ -0,0 +1,10 @@
+#version 450
+layout(location=0) in vec3 inPos;
+layout(location=1) in vec2 inUV;
+layout(binding=0) uniform UBO { mat4 viewProj; } ubo;
+layout(std430, binding=2) readonly buffer Instances { mat4 model[]; } inst;
+layout(location=0) out vec2 vUV;
+void main() {
+    gl_Position = ubo.viewProj * (inst.model[gl_InstanceIndex] * vec4(inPos, 1.0));
+    vUV = inUV;
+}
@@ -0,0 +1,255 @@
+#include "suballocator.hpp"
+#include "staging_ring.hpp"
+#include "microbench.hpp"
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace vkmini {
+
+static constexpr uint64_t kBlockBytes = 64ull * 1024 * 1024;
+static constexpr uint64_t kGranularity = 1024; // a common bufferImageGranularity on discrete GPUs
+static constexpr uint64_t kChurnLive = 512;    // allocations kept alive during churn
+
+static bool page_shared(uint64_t endA, uint64_t startB)
+{
+    return (endA - 1) / kGranularity == startB / kGranularity;
+}
+
+// Each check returns an error message, or null when the allocator behaved.
+static const char* check_alignment()
+{
+    BlockSuballocator b(kBlockBytes, kGranularity);
+    for (uint64_t align = 1; align <= 65536; align *= 2)
+    {
+        // An odd size first, so the next offset is misaligned unless padded.
+        if (!b.allocate(3, 1, ResourceKind::Linear)) return "alignment: block full";
+        const auto off = b.allocate(100, align, ResourceKind::Linear);
+        if (!off || *off % align) return "alignment: misaligned offset";
+    }
+    return nullptr;
+}
+
+static const char* check_granularity()
+{
+    {
+        // Same kind packs tightly.
+        BlockSuballocator b(kBlockBytes, kGranularity);
+        b.allocate(100, 4, ResourceKind::Linear);
+        const auto off = b.allocate(100, 4, ResourceKind::Linear);
+        if (!off || *off != 100) return "granularity: same-kind ranges were separated";
+    }
+    for (const auto& [first, second] : { std::pair{ ResourceKind::Linear, ResourceKind::Optimal },
+                                        std::pair{ ResourceKind::Optimal, ResourceKind::Linear } })
+    {
+        // A different kind after: pushed to the next page.
+        BlockSuballocator b(kBlockBytes, kGranularity);
+        const auto a = b.allocate(100, 16, first);
+        const auto c = b.allocate(100, 16, second);
+        if (!a || !c || page_shared(*a + 100, *c)) return "granularity: different kinds share a page after";
+    }
+    {
+        // A hole in front of a range of the other kind: what goes there must end a page early.
+        BlockSuballocator b(2 * kGranularity, kGranularity);
+        const auto pad = b.allocate(kGranularity + 512, 1, ResourceKind::Optimal);
+        const auto opt = b.allocate(256, 1, ResourceKind::Optimal);
+        if (!pad || !opt) return "granularity: setup failed";
+        b.free(*pad);
+        if (b.allocate(kGranularity + 256, 1, ResourceKind::Linear)) return "granularity: filled the hole up to a different kind";
+        const auto lin = b.allocate(512, 1, ResourceKind::Linear);
+        if (!lin || page_shared(*lin + 512, *opt)) return "granularity: hole before a different kind not used";
+    }
+    return nullptr;
+}
+
+static const char* check_free_coalesce()
+{
+    BlockSuballocator b(4096, 1);
+    const auto x = b.allocate(1024, 1, ResourceKind::Linear);
+    const auto y = b.allocate(1024, 1, ResourceKind::Linear);
+    const auto z = b.allocate(2048, 1, ResourceKind::Linear);
+    if (!x || !y || !z || b.allocate(1, 1, ResourceKind::Linear)) return "free: block not exactly full";
+
+    b.free(*y); // a hole between two used ranges
+    if (b.stats().freeRanges != 1 || b.stats().largestFree != 1024) return "free: hole not reported";
+    b.free(*x); // merges with the hole after it
+    if (b.stats().freeRanges != 1 || b.stats().largestFree != 2048) return "free: not merged with the next range";
+    b.free(*z); // merges with the range before it
+    const BlockStats st = b.stats();
+    if (!b.empty() || st.freeRanges != 1 || st.largestFree != 4096 || st.used) return "free: block not whole again";
+
+    if (b.free(*y) || b.free(4096 / 3)) return "free: double or foreign free not rejected";
+    if (!b.empty() || b.stats().freeRanges != 1) return "free: rejected free changed the block";
+    return nullptr;
+}
+
+static const char* check_fragmentation()
+{
+    // Free every other range: half the block is free, but no free range is larger than one.
+    constexpr uint64_t chunk = 4096, count = 64;
+    BlockSuballocator b(chunk * count, 1);
+    std::vector<uint64_t> offsets;
+    for (uint64_t i=0;i<count;++i) offsets.push_back(*b.allocate(chunk, 1, ResourceKind::Linear));
+    for (uint64_t i=0;i<count;i+=2) b.free(offsets[i]);
+
+    const BlockStats st = b.stats();
+    if (st.used != chunk * count / 2 || st.allocations != count / 2) return "fragmentation: wrong usage";
+    if (st.freeRanges != count / 2 || st.largestFree != chunk) return "fragmentation: wrong free ranges";
+    if (b.allocate(chunk * 2, 1, ResourceKind::Linear)) return "fragmentation: allocated across used ranges";
+    return nullptr;
+}
+
+// Random allocations and frees against a shadow map: no overlap, alignment kept, no two kinds on
+// one page, and the reported usage matches.
+static const char* check_random(uint32_t ops)
+{
+    std::mt19937_64 rng(42);
+    BlockSuballocator b(kBlockBytes / 16, kGranularity);
+    struct Live { uint64_t size; ResourceKind kind; };
+    std::map<uint64_t, Live> live;
+    uint64_t used = 0;
+    for (uint32_t i=0;i<ops;++i)
+    {
+        if (!live.empty() && (rng() % 3 == 0 || live.size() >= kChurnLive))
+        {
+            auto it = std::next(live.begin(), long(rng() % live.size()));
+            b.free(it->first);
+            used -= it->second.size;
+            live.erase(it);
+            continue;
+        }
+        const uint64_t size = 1 + rng() % 65536, align = 1ull << (rng() % 13);
+        const ResourceKind kind = rng() % 2 ? ResourceKind::Linear : ResourceKind::Optimal;
+        const auto off = b.allocate(size, align, kind);
+        if (!off) continue;
+        if (*off % align) return "random: misaligned offset";
+        const auto [it, inserted] = live.emplace(*off, Live{ size, kind });
+        if (!inserted) return "random: offset handed out twice";
+        used += size;
+        if (it != live.begin())
+        {
+            const auto prev = std::prev(it);
+            if (prev->first + prev->second.size > *off) return "random: overlaps the previous range";
+            if (prev->second.kind != kind && page_shared(prev->first + prev->second.size, *off))
+                return "random: shares a page with the previous range";
+        }
+        if (const auto next = std::next(it); next != live.end())
+        {
+            if (*off + size > next->first) return "random: overlaps the next range";
+            if (next->second.kind != kind && page_shared(*off + size, next->first))
+                return "random: shares a page with the next range";
+        }
+    }
+    const BlockStats st = b.stats();
+    if (st.used != used || st.allocations != live.size()) return "random: stats disagree with the live set";
+    return nullptr;
+}
+
+// The upload staging ring: the wrap rule on a small ring, then random uploads against the live
+// ranges, with a batch submitted every few uploads and batches completing in order behind.
+static const char* check_staging_ring(uint32_t ops)
+{
+    {
+        StagingRing r(100, 1);
+        r.occupy(0, 40, 1);
+        r.occupy(40, 40, 2);
+        if (r.find(30)) return "staging ring: handed out space that is in use";
+        r.release(1); // [0, 40) is free again; 30 bytes do not fit after 80, so they go to the front
+        if (r.find(30) != 0) return "staging ring: did not wrap to the front";
+        r.occupy(0, 30, 3);
+        if (r.find(10) != 30 || r.find(11)) return "staging ring: wrapped head runs into the tail";
+        r.release(3);
+        if (!r.empty() || r.find(100) != 0) return "staging ring: not empty after every batch completed";
+    }
+
+    constexpr uint64_t kCapacity = 1 << 20, kAlign = 16;
+    std::mt19937_64 rng(3);
+    StagingRing ring(kCapacity, kAlign);
+    struct Live { uint64_t ticket, begin, end; };
+    std::deque<Live> live;
+    uint64_t ticket = 1, completed = 0, wraps = 0, last = 0;
+    const auto complete_oldest = [&] {
+        if (completed + 1 == ticket) ++ticket; // submit the open batch first
+        ring.release(++completed);
+        while (!live.empty() && live.front().ticket <= completed) live.pop_front();
+    };
+    for (uint32_t i=0;i<ops;++i)
+    {
+        const uint64_t bytes = 1 + rng() % (kCapacity / 8);
+        std::optional<uint64_t> off;
+        while (!(off = ring.find(bytes)))
+        {
+            if (ring.empty()) return "staging ring: refused an empty ring";
+            complete_oldest();
+        }
+        if (*off % kAlign) return "staging ring: misaligned offset";
+        if (*off + bytes > kCapacity) return "staging ring: range past the end";
+        for (const Live& l : live)
+            if (*off < l.end && l.begin < *off + bytes) return "staging ring: overlaps a range in use";
+        wraps += *off < last;
+        last = *off;
+        ring.occupy(*off, bytes, ticket);
+        live.push_back(Live{ ticket, *off, *off + bytes });
+        if (rng() % 4 == 0) ++ticket;
+        if (rng() % 8 == 0 && completed + 1 < ticket) complete_oldest();
+    }
+    if (ops >= 64 && !wraps) return "staging ring: never wrapped";
+    return nullptr;
+}
+
+int run_alloc_bench(uint32_t ops)
+{
+    std::cout << "[vkmini] Alloc bench: " << ops << " operations per run, " << kBlockBytes / (1024 * 1024)
+              << " MiB block, granularity " << kGranularity << "\n";
+    bool ok = true;
+    for (const char* error : { check_alignment(), check_granularity(), check_free_coalesce(),
+                               check_fragmentation(), check_random(ops), check_staging_ring(ops) })
+    {
+        if (!error) continue;
+        std::cerr << "[vkmini] Alloc bench: " << error << "\n";
+        ok = false;
+    }
+
+    // Churn: a steady set of live allocations of mixed sizes and kinds, one freed per allocation.
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> sizes(ops), aligns(ops);
+    std::vector<ResourceKind> kinds(ops);
+    for (uint32_t i=0;i<ops;++i)
+    {
+        sizes[i] = 256 + rng() % (64 * 1024);
+        aligns[i] = 1ull << (8 + rng() % 5);
+        kinds[i] = rng() % 4 ? ResourceKind::Linear : ResourceKind::Optimal;
+    }
+    BlockStats steady{};
+    uint64_t failed = 0;
+    const BenchTiming t = time_runs([&] {
+        BlockSuballocator b(kBlockBytes, kGranularity);
+        std::vector<uint64_t> ring(kChurnLive, UINT64_MAX);
+        failed = 0;
+        for (uint32_t i=0;i<ops;++i)
+        {
+            uint64_t& slot = ring[i % kChurnLive];
+            if (slot != UINT64_MAX) b.free(slot);
+            const auto off = b.allocate(sizes[i], aligns[i], kinds[i]);
+            slot = off.value_or(UINT64_MAX);
+            failed += !off;
+        }
+        steady = b.stats();
+    });
+
+    const uint64_t free = steady.size - steady.used;
+    char line[200];
+    std::snprintf(line, sizeof(line), "  churn  min %8.3f ms  median %8.3f ms  %6.2f Mops/s  %llu failed  "
+        "%u live, %u free ranges, largest %.1f%% of free\n",
+        t.minMs, t.medianMs, 2.0 * ops / (t.medianMs * 1000.0), (unsigned long long)failed,
+        steady.allocations, steady.freeRanges, free ? 100.0 * double(steady.largestFree) / double(free) : 100.0);
+    std::cout << line;
+    return ok ? 0 : 1;
+}
+
+} // namespace vkmini
@@ -0,0 +1,127 @@
+#include "app_options.hpp"
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace vkmini {
+
+static constexpr const char* kUsage =
+    "usage: vulkan_app [--headless | --headless-surface [--window-script SCRIPT]] [--frames N] [--size WxH] [--readback out.ppm] [--instances N] [--gpu-cull | --cpu-cull]\n"
+    "                  [--draw-per-instance] [--stream-texture N] [--record-threads N] [--frames-in-flight N] [--swapchain-images N]\n"
+    "                  [--bench N] [--bench-out report.json] [--bench-compare baseline.json] [--bench-threshold PERCENT]\n"
+    "                  [--gpu-profile] [--trace out.json] [--gpu-trace out.json] [--resize-debounce MS] [--resize-replay]";
+
+static constexpr uint32_t kMaxFramesInFlight = 8;
+
+[[noreturn]] static void bad_args(std::string_view what)
+{
+    throw std::runtime_error(std::string(what) + "\n" + kUsage);
+}
+
+static uint32_t parse_u32(std::string_view s, std::string_view flag)
+{
+    uint32_t v = 0;
+    const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec != std::errc{} || end != s.data() + s.size())
+        bad_args(std::string(flag) + ": expected a number, got '" + std::string(s) + "'");
+    return v;
+}
+
+static double parse_double(std::string_view s, std::string_view flag)
+{
+    double v = 0;
+    const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec != std::errc{} || end != s.data() + s.size())
+        bad_args(std::string(flag) + ": expected a number, got '" + std::string(s) + "'");
+    return v;
+}
+
+AppOptions parse_options(int argc, char** argv)
+{
+    AppOptions o{};
+#if VKMINI_HEADLESS
+    o.headless = true;
+#endif
+
+    bool framesSet = false; // --bench N sets the frame count too
+    for (int i=1;i<argc;++i)
+    {
+        const std::string_view arg = argv[i];
+        auto value = [&]() -> std::string_view {
+            if (i + 1 >= argc) bad_args(std::string(arg) + " needs a value");
+            return argv[++i];
+        };
+
+        if (arg == "--headless") o.headless = true;
+        else if (arg == "--headless-surface") o.headlessSurface = true;
+        else if (arg == "--window-script") o.windowScript = value();
+        else if (arg == "--frames")
+        {
+            o.frames = parse_u32(value(), arg);
+            framesSet = true;
+        }
+        else if (arg == "--size")
+        {
+            const std::string_view v = value();
+            const size_t x = v.find('x');
+            if (x == std::string_view::npos) bad_args("--size: expected WxH");
+            o.width  = parse_u32(v.substr(0, x), arg);
+            o.height = parse_u32(v.substr(x + 1), arg);
+            if (!o.width || !o.height) bad_args("--size: width and height must be non-zero");
+        }
+        else if (arg == "--readback") o.readback = value();
+        else if (arg == "--instances")
+        {
+            o.instances = parse_u32(value(), arg);
+            if (!o.instances) bad_args("--instances: count must be non-zero");
+        }
+        else if (arg == "--gpu-cull") o.gpuCull = true;
+        else if (arg == "--cpu-cull") o.cpuCull = true;
+        else if (arg == "--draw-per-instance") o.drawPerInstance = true;
+        else if (arg == "--stream-texture")
+        {
+            o.streamTexture = parse_u32(value(), arg);
+            if (!o.streamTexture) bad_args("--stream-texture: frame count must be non-zero");
+        }
+        else if (arg == "--record-threads")
+        {
+            o.recordThreads = parse_u32(value(), arg);
+            if (!o.recordThreads) bad_args("--record-threads: thread count must be non-zero");
+        }
+        else if (arg == "--frames-in-flight")
+        {
+            o.framesInFlight = parse_u32(value(), arg);
+            if (o.framesInFlight < 1 || o.framesInFlight > kMaxFramesInFlight)
+                bad_args("--frames-in-flight: expected 1.." + std::to_string(kMaxFramesInFlight));
+        }
+        else if (arg == "--swapchain-images") o.swapchainImages = parse_u32(value(), arg);
+        else if (arg == "--resize-debounce") o.resizeDebounceMs = parse_u32(value(), arg);
+        else if (arg == "--resize-replay") o.resizeReplay = true;
+        else if (arg == "--bench")
+        {
+            o.bench = true;
+            o.frames = parse_u32(value(), arg);
+            if (!o.frames) bad_args("--bench: frame count must be non-zero");
+        }
+        else if (arg == "--bench-out") o.benchOut = value();
+        else if (arg == "--bench-compare") o.benchCompare = value();
+        else if (arg == "--bench-threshold") o.benchThreshold = parse_double(value(), arg) / 100.0;
+        else if (arg == "--gpu-profile") o.gpuProfile = true;
+        else if (arg == "--trace") o.trace = value();
+        else if (arg == "--gpu-trace") { o.trace = value(); o.gpuProfile = true; }
+        else bad_args("unknown argument '" + std::string(arg) + "'");
+    }
+
+    if (!o.readback.empty() && !o.headless) bad_args("--readback requires --headless");
+    if (o.headless && o.headlessSurface) bad_args("--headless and --headless-surface are exclusive");
+    if (!o.windowScript.empty() && !o.headlessSurface) bad_args("--window-script requires --headless-surface");
+    if (o.gpuCull && o.cpuCull) bad_args("--gpu-cull and --cpu-cull are exclusive");
+    if (o.gpuCull && o.drawPerInstance) bad_args("--draw-per-instance does not apply to the --gpu-cull indirect draw");
+    if (o.bench && framesSet) bad_args("--bench N sets the frame count; it cannot be combined with --frames");
+    if ((!o.benchOut.empty() || !o.benchCompare.empty()) && !o.bench) bad_args("--bench-out/--bench-compare require --bench N");
+    if (o.headless && o.frames == 0) o.frames = 100;
+    return o;
+}
+
+} // namespace vkmini
@@ -0,0 +1,275 @@
+#include "bench.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace vkmini {
+
+// Differences below this are timer/scheduler noise, whatever the relative change.
+static constexpr double kNoiseFloorMs = 0.02;
+
+const char* bench_phase_name(BenchPhase p)
+{
+    switch (p)
+    {
+    case BenchPhase::Frame:   return "frame";
+    case BenchPhase::Wait:    return "wait";
+    case BenchPhase::Acquire: return "acquire";
+    case BenchPhase::Record:  return "record";
+    case BenchPhase::Submit:  return "submit";
+    case BenchPhase::Present: return "present";
+    default:                  return "?";
+    }
+}
+
+void BenchRecorder::start(uint32_t frames, uint32_t warmup)
+{
+    active_ = true;
+    frames_ = frames;
+    warmup_ = warmup;
+    frame_ = 0;
+    pendingMask_ = 0;
+    for (auto& s : samples_)
+    {
+        s.clear();
+        s.reserve(frames);
+    }
+}
+
+void BenchRecorder::begin_frame()
+{
+    if (!active_) return;
+    pendingMask_ = 0;
+    frameStart_ = std::chrono::steady_clock::now();
+}
+
+void BenchRecorder::end_frame()
+{
+    if (!active_) return;
+    add(BenchPhase::Frame, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart_).count());
+    if (++frame_ > warmup_)
+        for (size_t i=0;i<kBenchPhaseCount;++i)
+            if (pendingMask_ & (1u << i)) samples_[i].push_back(pending_[i]);
+    pendingMask_ = 0;
+}
+
+// Nearest-rank percentile of a sorted sample set.
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    const size_t rank = (size_t)std::ceil(p * double(sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+PhaseStats BenchRecorder::stats(BenchPhase p) const
+{
+    std::vector<double> v = samples_[size_t(p)];
+    PhaseStats st{};
+    if (v.empty()) return st;
+
+    std::sort(v.begin(), v.end());
+    st.samples = (uint32_t)v.size();
+    st.min = v.front();
+    st.max = v.back();
+    st.mean = std::accumulate(v.begin(), v.end(), 0.0) / double(v.size());
+    st.p50 = percentile(v, 0.50);
+    st.p95 = percentile(v, 0.95);
+    st.p99 = percentile(v, 0.99);
+    return st;
+}
+
+static std::string json_escape(const std::string& s)
+{
+    std::string out;
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if ((unsigned char)c < 0x20)
+        {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)(unsigned char)c);
+            out += buf;
+        }
+        else out += c;
+    }
+    return out;
+}
+
+std::string BenchRecorder::to_json(const BenchInfo& info) const
+{
+    std::ostringstream os;
+    os << std::setprecision(6);
+    os << "{\n"
+       << "  \"vkmini_bench\": 1,\n"
+       << "  \"device\": \"" << json_escape(info.device) << "\",\n"
+       << "  \"mode\": \"" << json_escape(info.mode) << "\",\n"
+       << "  \"width\": " << info.width << ",\n"
+       << "  \"height\": " << info.height << ",\n"
+       << "  \"frames\": " << frames_ << ",\n"
+       << "  \"warmup\": " << warmup_ << ",\n"
+       << "  \"phases\": {";
+
+    bool first = true;
+    for (size_t i=0;i<kBenchPhaseCount;++i)
+    {
+        const PhaseStats st = stats(BenchPhase(i));
+        if (!st.samples) continue;
+        os << (first ? "\n" : ",\n") << "    \"" << bench_phase_name(BenchPhase(i)) << "\": { "
+           << "\"samples\": " << st.samples
+           << ", \"min\": " << st.min << ", \"mean\": " << st.mean
+           << ", \"p50\": " << st.p50 << ", \"p95\": " << st.p95
+           << ", \"p99\": " << st.p99 << ", \"max\": " << st.max << " }";
+        first = false;
+    }
+    os << "\n  }\n}\n";
+    return os.str();
+}
+
+namespace {
+
+// Just enough JSON for the reports to_json writes: objects, strings and numbers.
+struct JsonValue {
+    double number = 0;
+    std::string string;
+    std::map<std::string, JsonValue> object;
+};
+
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& text) : s_(text) {}
+
+    JsonValue parse()
+    {
+        JsonValue v = value();
+        skip_ws();
+        if (pos_ != s_.size()) fail("trailing characters");
+        return v;
+    }
+
+private:
+    [[noreturn]] void fail(const char* what) const
+    {
+        throw std::runtime_error(std::string("bench baseline: ") + what + " at offset " + std::to_string(pos_));
+    }
+    void skip_ws() { while (pos_ < s_.size() && std::isspace((unsigned char)s_[pos_])) ++pos_; }
+    void expect(char c)
+    {
+        skip_ws();
+        if (pos_ >= s_.size() || s_[pos_] != c) fail("unexpected character");
+        ++pos_;
+    }
+
+    JsonValue value()
+    {
+        skip_ws();
+        if (pos_ >= s_.size()) fail("unexpected end");
+        JsonValue v{};
+        if (s_[pos_] == '{') v.object = object();
+        else if (s_[pos_] == '"') v.string = string();
+        else v.number = number();
+        return v;
+    }
+
+    std::map<std::string, JsonValue> object()
+    {
+        std::map<std::string, JsonValue> obj;
+        expect('{');
+        skip_ws();
+        if (pos_ < s_.size() && s_[pos_] == '}') { ++pos_; return obj; }
+        for (;;)
+        {
+            skip_ws();
+            std::string key = string();
+            expect(':');
+            obj[std::move(key)] = value();
+            skip_ws();
+            if (pos_ < s_.size() && s_[pos_] == ',') { ++pos_; continue; }
+            expect('}');
+            return obj;
+        }
+    }
+
+    std::string string()
+    {
+        expect('"');
+        std::string out;
+        while (pos_ < s_.size() && s_[pos_] != '"')
+        {
+            char c = s_[pos_++];
+            if (c == '\\' && pos_ < s_.size())
+            {
+                c = s_[pos_++];
+                if (c == 'u') { pos_ += 4; c = '?'; } // only used for control characters
+            }
+            out += c;
+        }
+        expect('"');
+        return out;
+    }
+
+    double number()
+    {
+        const char* begin = s_.c_str() + pos_;
+        char* end = nullptr;
+        const double v = std::strtod(begin, &end);
+        if (end == begin) fail("expected a value");
+        pos_ += size_t(end - begin);
+        return v;
+    }
+
+    const std::string& s_;
+    size_t pos_ = 0;
+};
+
+} // namespace
+
+bool BenchRecorder::compare(const std::string& baselinePath, double threshold, std::ostream& out) const
+{
+    std::ifstream in(baselinePath, std::ios::binary);
+    if (!in) throw std::runtime_error("bench baseline: cannot open " + baselinePath);
+    const std::string text{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+
+    const JsonValue root = JsonReader(text).parse();
+    const auto phases = root.object.find("phases");
+    if (phases == root.object.end()) throw std::runtime_error("bench baseline: no \"phases\" in " + baselinePath);
+
+    bool ok = true;
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(3)
+        << "[bench] vs " << baselinePath << " (threshold " << threshold * 100.0 << "%)\n";
+    for (size_t i=0;i<kBenchPhaseCount;++i)
+    {
+        const char* name = bench_phase_name(BenchPhase(i));
+        const PhaseStats cur = stats(BenchPhase(i));
+        const auto base = phases->second.object.find(name);
+        if (!cur.samples || base == phases->second.object.end()) continue;
+
+        for (const auto& [metric, now] : { std::pair{ "p50", cur.p50 }, std::pair{ "p95", cur.p95 } })
+        {
+            const auto m = base->second.object.find(metric);
+            if (m == base->second.object.end()) continue;
+            const double was = m->second.number;
+            const bool regressed = now > was * (1.0 + threshold) && now - was > kNoiseFloorMs;
+            ok = ok && !regressed;
+            out << "  " << std::left << std::setw(8) << name << std::setw(4) << metric << std::right
+                << std::setw(10) << was << " -> " << std::setw(10) << now << " ms  "
+                << std::showpos << (was > 0 ? (now / was - 1.0) * 100.0 : 0.0) << std::noshowpos << "%"
+                << (regressed ? "  REGRESSION" : "") << "\n";
+        }
+    }
+    out.flags(flags);
+    out.precision(precision);
+    return ok;
+}
+
+} // namespace vkmini
@@ -0,0 +1,179 @@
+#include "bench.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace vkmini {
+
+// Marks samples of warm-up and abandoned iterations; none may reach the stats.
+static constexpr double kDiscarded = 1e6;
+
+static bool near(double a, double b) { return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b)); }
+
+// `frames` frames of Record samples 1..frames (times scale) in shuffled order, after `warmup`
+// frames and with every third frame preceded by an abandoned iteration.
+static BenchRecorder recorded(uint32_t frames, uint32_t warmup, double scale)
+{
+    std::vector<double> values(frames);
+    std::iota(values.begin(), values.end(), 1.0);
+    std::shuffle(values.begin(), values.end(), std::mt19937(frames));
+
+    BenchRecorder r;
+    r.start(frames, warmup);
+    for (uint32_t i=0;i<warmup;++i)
+    {
+        r.begin_frame();
+        r.add(BenchPhase::Record, kDiscarded);
+        r.end_frame();
+    }
+    for (uint32_t i=0;i<frames;++i)
+    {
+        if (i % 3 == 0)
+        {
+            r.begin_frame();
+            r.add(BenchPhase::Record, kDiscarded);
+            r.add(BenchPhase::Wait, kDiscarded);
+        }
+        r.begin_frame();
+        r.add(BenchPhase::Record, values[i] * scale);
+        r.end_frame();
+    }
+    return r;
+}
+
+static BenchRecorder constant(double ms)
+{
+    BenchRecorder r;
+    r.start(10, 0);
+    for (int i=0;i<10;++i)
+    {
+        r.begin_frame();
+        r.add(BenchPhase::Record, ms);
+        r.end_frame();
+    }
+    return r;
+}
+
+// Each check returns an error message, or null when the recorder behaved.
+static const char* check_percentiles()
+{
+    // Nearest rank: p of n samples is the ceil(p*n)-th smallest.
+    struct Case { uint32_t n; double p50, p95, p99; };
+    for (const Case c : { Case{ 1, 1, 1, 1 }, Case{ 7, 4, 7, 7 }, Case{ 20, 10, 19, 20 }, Case{ 100, 50, 95, 99 } })
+    {
+        const PhaseStats st = recorded(c.n, 2, 0.5).stats(BenchPhase::Record);
+        if (st.samples != c.n) return "percentiles: warm-up or abandoned frames were recorded";
+        if (!near(st.min, 0.5) || !near(st.max, c.n * 0.5) || !near(st.mean, (c.n + 1) * 0.25))
+            return "percentiles: wrong min, max or mean";
+        if (!near(st.p50, c.p50 * 0.5) || !near(st.p95, c.p95 * 0.5) || !near(st.p99, c.p99 * 0.5))
+            return "percentiles: wrong p50, p95 or p99";
+    }
+    return nullptr;
+}
+
+static const char* check_staging()
+{
+    const BenchRecorder r = recorded(30, 5, 1.0);
+    if (r.stats(BenchPhase::Frame).samples != 30) return "staging: Frame samples do not match the frames ended";
+    if (r.stats(BenchPhase::Wait).samples) return "staging: an abandoned iteration left a sample";
+    if (r.stats(BenchPhase::Acquire).samples) return "staging: a phase never timed has samples";
+
+    BenchRecorder idle;
+    idle.begin_frame();
+    idle.add(BenchPhase::Record, 1.0);
+    idle.end_frame();
+    if (idle.stats(BenchPhase::Record).samples || idle.stats(BenchPhase::Frame).samples)
+        return "staging: an inactive recorder recorded";
+    return nullptr;
+}
+
+static void write_file(const std::filesystem::path& path, const std::string& text)
+{
+    std::ofstream(path, std::ios::binary) << text;
+}
+
+static bool compares_ok(const BenchRecorder& r, const std::filesystem::path& baseline, double threshold)
+{
+    std::ostringstream table;
+    return r.compare(baseline.string(), threshold, table);
+}
+
+static const char* check_round_trip(uint32_t frames, const std::filesystem::path& path)
+{
+    const BenchRecorder r = recorded(frames, 10, 0.1);
+    BenchInfo info;
+    info.device = "GPU \"quoted\" \\ tab\t";
+    info.mode = "headless";
+    const std::string json = r.to_json(info);
+    if (json.find(R"("device": "GPU \"quoted\" \\ tab\u0009")") == std::string::npos)
+        return "round trip: device name not escaped";
+    write_file(path, json);
+
+    // Equal runs never regress; a uniformly slower one does, a uniformly faster one does not.
+    if (!compares_ok(r, path, 0.0)) return "round trip: a report regressed against itself";
+    if (compares_ok(recorded(frames, 10, 0.2), path, 0.10)) return "round trip: a 2x slower run passed";
+    if (!compares_ok(recorded(frames, 10, 0.05), path, 0.10)) return "round trip: a 2x faster run regressed";
+    return nullptr;
+}
+
+static const char* check_threshold(const std::filesystem::path& path)
+{
+    // Phases missing from the baseline (here Frame) are not compared.
+    write_file(path, R"({ "phases": { "record": { "p50": 10, "p95": 10 } } })");
+    if (!compares_ok(constant(10.5), path, 0.10)) return "compare: 5% slower failed a 10% threshold";
+    if (compares_ok(constant(12.0), path, 0.10)) return "compare: 20% slower passed a 10% threshold";
+
+    write_file(path, R"({ "phases": { "record": { "p50": 0.010, "p95": 0.010 } } })");
+    if (!compares_ok(constant(0.025), path, 0.10)) return "compare: a change within the noise floor regressed";
+    if (compares_ok(constant(0.040), path, 0.10)) return "compare: a change above the noise floor passed";
+    return nullptr;
+}
+
+static const char* check_bad_baselines(const std::filesystem::path& path)
+{
+    const BenchRecorder r = constant(1.0);
+    for (const char* text : { R"({ "phases": { "record": { "p50": 1 )", R"({ "frames": 3 })",
+                              R"({ "phases": {} } trailing)", "" })
+    {
+        write_file(path, text);
+        bool threw = false;
+        try { compares_ok(r, path, 0.10); }
+        catch (const std::runtime_error&) { threw = true; }
+        if (!threw) return "compare: a malformed baseline was accepted";
+    }
+    std::filesystem::remove(path);
+    bool threw = false;
+    try { compares_ok(r, path, 0.10); }
+    catch (const std::runtime_error&) { threw = true; }
+    return threw ? nullptr : "compare: a missing baseline was accepted";
+}
+
+int run_bench_selftest(uint32_t frames)
+{
+    std::cout << "[vkmini] Bench self-test: " << frames << " frames per report\n";
+    const auto path = std::filesystem::temp_directory_path() /
+        ("vkmini_bench_selftest_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".json");
+    bool ok = true;
+    for (const char* error : { check_percentiles(), check_staging(), check_round_trip(frames, path),
+                               check_threshold(path), check_bad_baselines(path) })
+    {
+        if (!error) continue;
+        std::cerr << "[vkmini] Bench self-test: " << error << "\n";
+        ok = false;
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::cout << "  " << (ok ? "ok" : "FAILED") << "\n";
+    return ok ? 0 : 1;
+}
+
+} // namespace vkmini
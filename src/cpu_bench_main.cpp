@@ -0,0 +1,46 @@
+#include "bench.hpp"
+#include "cull.hpp"
+#include "debug_sink.hpp"
+#include "jobs.hpp"
+#include "math.hpp"
+#include "suballocator.hpp"
+#include "trace.hpp"
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+
+// cpu_bench: the self-checks and microbenchmarks of the Vulkan-free modules. Builds without the
+// Vulkan SDK, glslc or a window system, and runs without a GPU or display.
+
+static constexpr const char* kUsage =
+    "usage: cpu_bench (--cull-bench N | --job-bench N | --alloc-bench N | --bench-selftest N |\n"
+    "                  --trace-bench N | --debug-sink-bench N | --math-bench N)";
+
+int main(int argc, char** argv)
+{
+    using namespace vkmini;
+    if (argc != 3)
+    {
+        std::cerr << kUsage << "\n";
+        return 2;
+    }
+    const std::string_view mode = argv[1], count = argv[2];
+    uint32_t n = 0;
+    const auto [end, ec] = std::from_chars(count.data(), count.data() + count.size(), n);
+    if (ec != std::errc{} || end != count.data() + count.size() || !n)
+    {
+        std::cerr << mode << ": expected a non-zero count, got '" << count << "'\n" << kUsage << "\n";
+        return 2;
+    }
+
+    if (mode == "--cull-bench") return run_cull_bench(n);
+    if (mode == "--job-bench") return run_job_bench(n);
+    if (mode == "--alloc-bench") return run_alloc_bench(n);
+    if (mode == "--bench-selftest") return run_bench_selftest(n);
+    if (mode == "--trace-bench") return run_trace_bench(n);
+    if (mode == "--debug-sink-bench") return run_debug_sink_bench(n);
+    if (mode == "--math-bench") return run_math_bench(n);
+    std::cerr << "unknown argument '" << mode << "'\n" << kUsage << "\n";
+    return 2;
+}
@@ -0,0 +1,228 @@
+#include "cull.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+// Same compile-time kernel selection as the Mat4 kernels in math.cpp (VKMINI_MATH_AVX2,
+// VKMINI_MATH_FORCE_SCALAR), so both report the same backend.
+#if !defined(VKMINI_MATH_FORCE_SCALAR) && defined(__AVX2__)
+    #define VKMINI_CULL_USE_AVX2 1
+    #include <immintrin.h>
+#elif !defined(VKMINI_MATH_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define VKMINI_CULL_USE_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+namespace vkmini {
+
+namespace {
+
+// Objects per chunk below which handing a chunk to a worker costs more than it saves.
+constexpr size_t kMinChunk = 4096;
+
+#if VKMINI_CULL_USE_AVX2
+
+using V = __m256;
+constexpr size_t kLanes = 8;
+inline V vload(const float* p) { return _mm256_loadu_ps(p); }
+inline V vset(float v) { return _mm256_set1_ps(v); }
+inline V vadd(V a, V b) { return _mm256_add_ps(a, b); }
+inline V vmul(V a, V b) { return _mm256_mul_ps(a, b); }
+inline V vneg(V a) { return _mm256_sub_ps(_mm256_setzero_ps(), a); }
+inline V vand(V a, V b) { return _mm256_and_ps(a, b); }
+inline V vge(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+inline V vtrue() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+inline unsigned vmask(V a) { return unsigned(_mm256_movemask_ps(a)); }
+
+#elif VKMINI_CULL_USE_SSE2
+
+using V = __m128;
+constexpr size_t kLanes = 4;
+inline V vload(const float* p) { return _mm_loadu_ps(p); }
+inline V vset(float v) { return _mm_set1_ps(v); }
+inline V vadd(V a, V b) { return _mm_add_ps(a, b); }
+inline V vmul(V a, V b) { return _mm_mul_ps(a, b); }
+inline V vneg(V a) { return _mm_sub_ps(_mm_setzero_ps(), a); }
+inline V vand(V a, V b) { return _mm_and_ps(a, b); }
+inline V vge(V a, V b) { return _mm_cmpge_ps(a, b); }
+inline V vtrue() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+inline unsigned vmask(V a) { return unsigned(_mm_movemask_ps(a)); }
+
+#else
+
+constexpr size_t kLanes = 1;
+
+#endif
+
+// The vector paths evaluate dot(n, c) + d and the box's projected radius in exactly this order,
+// so they accept the same objects as these scalar tails.
+inline bool sphere_visible(const Frustum& f, float x, float y, float z, float r)
+{
+    for (const auto& p : f.planes)
+        if (p[0]*x + p[1]*y + p[2]*z + p[3] < -r) return false;
+    return true;
+}
+
+inline bool aabb_visible(const Frustum& f, float x, float y, float z, float ex, float ey, float ez)
+{
+    for (const auto& p : f.planes)
+    {
+        const float r = std::fabs(p[0])*ex + std::fabs(p[1])*ey + std::fabs(p[2])*ez;
+        if (p[0]*x + p[1]*y + p[2]*z + p[3] < -r) return false;
+    }
+    return true;
+}
+
+// Appends base + the index of every set bit of mask.
+inline size_t emit(unsigned mask, size_t base, uint32_t* out)
+{
+    size_t n = 0;
+    for (; mask; mask &= mask - 1)
+        out[n++] = uint32_t(base + std::countr_zero(mask));
+    return n;
+}
+
+} // namespace
+
+Frustum extract_frustum(const Mat4& viewProj)
+{
+    const auto row = [&](int r, int c) { return viewProj.m[r + c*4]; };
+    Frustum f{};
+    for (int c=0;c<4;++c)
+    {
+        f.planes[0][c] = row(3,c) + row(0,c);
+        f.planes[1][c] = row(3,c) - row(0,c);
+        f.planes[2][c] = row(3,c) + row(1,c);
+        f.planes[3][c] = row(3,c) - row(1,c);
+        f.planes[4][c] = row(2,c);
+        f.planes[5][c] = row(3,c) - row(2,c);
+    }
+    for (auto& p : f.planes)
+    {
+        const float len = std::sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]);
+        for (int c=0;c<4;++c) p[c] /= len;
+    }
+    return f;
+}
+
+void SphereSoA::push_back(float cx, float cy, float cz, float radius)
+{
+    x.push_back(cx); y.push_back(cy); z.push_back(cz); r.push_back(radius);
+}
+
+void AabbSoA::push_back(float x, float y, float z, float hx, float hy, float hz)
+{
+    cx.push_back(x); cy.push_back(y); cz.push_back(z);
+    ex.push_back(hx); ey.push_back(hy); ez.push_back(hz);
+}
+
+size_t cull_spheres(const Frustum& f, const SphereSoA& s, size_t begin, size_t end, uint32_t* out)
+{
+    size_t n = 0, i = begin;
+#if VKMINI_CULL_USE_AVX2 || VKMINI_CULL_USE_SSE2
+    V p[6][4];
+    for (int k=0;k<6;++k)
+        for (int c=0;c<4;++c) p[k][c] = vset(f.planes[k][c]);
+
+    for (; i + kLanes <= end; i += kLanes)
+    {
+        const V x = vload(s.x.data() + i), y = vload(s.y.data() + i), z = vload(s.z.data() + i);
+        const V negr = vneg(vload(s.r.data() + i));
+        V inside = vtrue();
+        for (int k=0;k<6;++k)
+        {
+            const V d = vadd(vadd(vadd(vmul(p[k][0], x), vmul(p[k][1], y)), vmul(p[k][2], z)), p[k][3]);
+            inside = vand(inside, vge(d, negr));
+        }
+        n += emit(vmask(inside), i, out + n);
+    }
+#endif
+    for (; i < end; ++i)
+        if (sphere_visible(f, s.x[i], s.y[i], s.z[i], s.r[i])) out[n++] = uint32_t(i);
+    return n;
+}
+
+size_t cull_aabbs(const Frustum& f, const AabbSoA& b, size_t begin, size_t end, uint32_t* out)
+{
+    size_t n = 0, i = begin;
+#if VKMINI_CULL_USE_AVX2 || VKMINI_CULL_USE_SSE2
+    V p[6][4], a[6][3]; // planes and the absolute values of their normals
+    for (int k=0;k<6;++k)
+    {
+        for (int c=0;c<4;++c) p[k][c] = vset(f.planes[k][c]);
+        for (int c=0;c<3;++c) a[k][c] = vset(std::fabs(f.planes[k][c]));
+    }
+
+    for (; i + kLanes <= end; i += kLanes)
+    {
+        const V x = vload(b.cx.data() + i), y = vload(b.cy.data() + i), z = vload(b.cz.data() + i);
+        const V ex = vload(b.ex.data() + i), ey = vload(b.ey.data() + i), ez = vload(b.ez.data() + i);
+        V inside = vtrue();
+        for (int k=0;k<6;++k)
+        {
+            const V r = vadd(vadd(vmul(a[k][0], ex), vmul(a[k][1], ey)), vmul(a[k][2], ez));
+            const V d = vadd(vadd(vadd(vmul(p[k][0], x), vmul(p[k][1], y)), vmul(p[k][2], z)), p[k][3]);
+            inside = vand(inside, vge(d, vneg(r)));
+        }
+        n += emit(vmask(inside), i, out + n);
+    }
+#endif
+    for (; i < end; ++i)
+        if (aabb_visible(f, b.cx[i], b.cy[i], b.cz[i], b.ex[i], b.ey[i], b.ez[i])) out[n++] = uint32_t(i);
+    return n;
+}
+
+uint32_t cull_lanes() { return uint32_t(kLanes); }
+
+size_t CpuCuller::cull(const Frustum& f, const SphereSoA& s, std::span<uint32_t> visible)
+{
+    return run([](const Frustum& f, const void* soa, size_t b, size_t e, uint32_t* out) {
+        return cull_spheres(f, *static_cast<const SphereSoA*>(soa), b, e, out);
+    }, &s, s.size(), f, visible);
+}
+
+size_t CpuCuller::cull(const Frustum& f, const AabbSoA& b, std::span<uint32_t> visible)
+{
+    return run([](const Frustum& f, const void* soa, size_t b, size_t e, uint32_t* out) {
+        return cull_aabbs(f, *static_cast<const AabbSoA*>(soa), b, e, out);
+    }, &b, b.size(), f, visible);
+}
+
+size_t CpuCuller::run(Kernel kernel, const void* soa, size_t count, const Frustum& f, std::span<uint32_t> visible)
+{
+    if (visible.size() < count) throw std::invalid_argument("CpuCuller::cull: output span too small");
+    VKMINI_TRACE_ZONE("cpu cull");
+
+    const uint32_t chunks = uint32_t(std::clamp<size_t>(count / kMinChunk, 1, threads()));
+    if (chunks == 1) return kernel(f, soa, 0, count, visible.data());
+
+    // Chunk boundaries on whole vectors; every chunk writes its indices at its own start.
+    size_t chunk = (count + chunks - 1) / chunks;
+    chunk = (chunk + kLanes - 1) / kLanes * kLanes;
+    written_.assign(chunks, 0);
+    const auto run_chunk = [&](uint32_t c) {
+        const size_t b = std::min(count, c * chunk);
+        const size_t e = std::min(count, b + chunk);
+        written_[c] = kernel(f, soa, b, e, visible.data() + b);
+    };
+    {
+        ScopedJobs group(jobs_);
+        for (uint32_t c=1;c<chunks;++c) group.run([&run_chunk, c] { run_chunk(c); });
+        run_chunk(0);
+        group.wait();
+    }
+
+    // Slide the chunks' lists down into one.
+    size_t n = written_[0];
+    for (uint32_t c=1;c<chunks;++c)
+    {
+        std::memmove(visible.data() + n, visible.data() + c * chunk, written_[c] * sizeof(uint32_t));
+        n += written_[c];
+    }
+    return n;
+}
+
+} // namespace vkmini
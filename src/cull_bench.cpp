@@ -0,0 +1,94 @@
+#include "cull.hpp"
+#include "math.hpp"
+#include "microbench.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace vkmini {
+
+// Objects are scattered through a 200-unit cube in front of a camera whose far plane cuts it,
+// so every plane rejects something and roughly a third of the objects survive.
+static constexpr float kBenchHalfExtent = 100.0f;
+
+static void report(const char* set, const char* what, uint32_t threads, uint32_t objects, const BenchTiming& t)
+{
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-7s %-7s %2u thread%s  min %8.3f ms  median %8.3f ms  %8.1f Mobj/s\n",
+        set, what, threads, threads == 1 ? " " : "s", t.minMs, t.medianMs, objects / (t.medianMs * 1000.0));
+    std::cout << line;
+}
+
+int run_cull_bench(uint32_t objects)
+{
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> pos(-kBenchHalfExtent, kBenchHalfExtent);
+    std::uniform_real_distribution<float> size(0.5f, 3.0f);
+
+    SphereSoA spheres;
+    AabbSoA boxes;
+    for (uint32_t i=0;i<objects;++i)
+    {
+        spheres.push_back(pos(rng), pos(rng), pos(rng), size(rng));
+        boxes.push_back(pos(rng), pos(rng), pos(rng), size(rng), size(rng), size(rng));
+    }
+
+    Mat4 proj = perspective(60.0f * 3.1415926f / 180.0f, 16.0f / 9.0f, 0.1f, 150.0f);
+    proj.m[5] *= -1.0f;
+    const Frustum f = extract_frustum(mul(proj, translate(0.0f, 0.0f, -(kBenchHalfExtent + 10.0f))));
+
+    // Scalar reference, written independently of the kernels.
+    std::vector<uint32_t> refSpheres, refBoxes;
+    for (uint32_t i=0;i<objects;++i)
+    {
+        bool sIn = true, bIn = true;
+        for (const auto& p : f.planes)
+        {
+            const float ds = p[0]*spheres.x[i] + p[1]*spheres.y[i] + p[2]*spheres.z[i] + p[3];
+            sIn = sIn && !(ds < -spheres.r[i]);
+            const float rb = std::fabs(p[0])*boxes.ex[i] + std::fabs(p[1])*boxes.ey[i] + std::fabs(p[2])*boxes.ez[i];
+            const float db = p[0]*boxes.cx[i] + p[1]*boxes.cy[i] + p[2]*boxes.cz[i] + p[3];
+            bIn = bIn && !(db < -rb);
+        }
+        if (sIn) refSpheres.push_back(i);
+        if (bIn) refBoxes.push_back(i);
+    }
+
+    std::cout << "[vkmini] Cull bench: " << objects << " objects, " << math_backend() << " (" << cull_lanes()
+              << " per instruction); visible " << refSpheres.size() << " spheres, " << refBoxes.size() << " boxes\n";
+
+    std::vector<uint32_t> visible(objects);
+    bool ok = true;
+    const auto check = [&](const char* what, size_t n, const std::vector<uint32_t>& ref) {
+        if (n == ref.size() && std::equal(ref.begin(), ref.end(), visible.begin())) return;
+        std::cerr << "[vkmini] Cull bench: " << what << " disagrees with the scalar reference ("
+                  << n << " vs " << ref.size() << " visible)\n";
+        ok = false;
+    };
+
+    size_t n = 0;
+    report("spheres", "kernel", 1, objects, time_runs([&] { n = cull_spheres(f, spheres, 0, objects, visible.data()); }));
+    check("sphere kernel", n, refSpheres);
+    report("boxes", "kernel", 1, objects, time_runs([&] { n = cull_aabbs(f, boxes, 0, objects, visible.data()); }));
+    check("box kernel", n, refBoxes);
+
+    std::vector<uint32_t> counts;
+    const uint32_t hw = std::max(1u, std::thread::hardware_concurrency());
+    for (uint32_t t=1;t<hw;t*=2) counts.push_back(t);
+    counts.push_back(hw);
+    for (uint32_t t : counts)
+    {
+        JobSystem jobs(t - 1);
+        CpuCuller culler(jobs);
+        report("spheres", "batch", t, objects, time_runs([&] { n = culler.cull(f, spheres, visible); }));
+        check("sphere batch", n, refSpheres);
+        report("boxes", "batch", t, objects, time_runs([&] { n = culler.cull(f, boxes, visible); }));
+        check("box batch", n, refBoxes);
+    }
+    return ok ? 0 : 1;
+}
+
+} // namespace vkmini
@@ -0,0 +1,156 @@
+#include "debug_sink.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ostream>
+#include <string_view>
+
+namespace vkmini {
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr auto kFlushInterval = std::chrono::milliseconds(10);
+static constexpr auto kRepeatReport = std::chrono::seconds(1);
+// Distinct messages remembered for folding; past this, new ones are printed (rate limited) but
+// their repeats are not folded.
+static constexpr size_t kMaxSeen = 4096;
+
+static const char* severity_name(uint32_t s)
+{
+    static constexpr const char* kNames[] = { "verbose", "info", "warning", "error" };
+    return kNames[s];
+}
+
+static void copy_truncated(char* dst, size_t size, const char* src)
+{
+    const size_t n = src ? std::min(std::strlen(src), size - 1) : 0;
+    if (n) std::memcpy(dst, src, n);
+    dst[n] = '\0';
+}
+
+DebugSink::DebugSink(std::ostream& out, std::array<double, 4> ratePerSecond)
+    : out_(out), rates_(ratePerSecond), thread_([this] { run(); })
+{
+}
+
+DebugSink::~DebugSink()
+{
+    stop_.store(true, std::memory_order_release);
+    thread_.join();
+}
+
+void DebugSink::post(DebugSeverity severity, bool performance, int32_t id, const char* idName, const char* text)
+{
+    const uint32_t sev = uint32_t(severity);
+    counts_[sev].fetch_add(1, std::memory_order_relaxed);
+    if (performance) performance_.fetch_add(1, std::memory_order_relaxed);
+
+    const bool queued = ring_.push([&](Message& m) {
+        m.severity = sev;
+        m.id = id;
+        copy_truncated(m.idName, sizeof(m.idName), idName);
+        copy_truncated(m.text, sizeof(m.text), text ? text : "(null)");
+    });
+    if (queued) posted_.fetch_add(1, std::memory_order_release);
+    else dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void DebugSink::flush()
+{
+    const uint64_t target = posted_.load(std::memory_order_acquire);
+    while (handled_.load(std::memory_order_acquire) < target)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+DebugMessageStats DebugSink::stats() const
+{
+    DebugMessageStats st;
+    st.verbose = counts_[0].load(std::memory_order_relaxed);
+    st.info = counts_[1].load(std::memory_order_relaxed);
+    st.warnings = counts_[2].load(std::memory_order_relaxed);
+    st.errors = counts_[3].load(std::memory_order_relaxed);
+    st.performance = performance_.load(std::memory_order_relaxed);
+    st.repeats = repeats_.load(std::memory_order_relaxed);
+    st.rateLimited = rateLimited_.load(std::memory_order_relaxed);
+    st.dropped = dropped_.load(std::memory_order_relaxed);
+    return st;
+}
+
+void DebugSink::run()
+{
+    std::array<double, 4> tokens = rates_;
+    Clock::time_point refill = Clock::now(), lastReport = refill;
+    for (;;)
+    {
+        const bool stopping = stop_.load(std::memory_order_acquire);
+        const Clock::time_point now = Clock::now();
+        const double elapsed = std::chrono::duration<double>(now - refill).count();
+        for (size_t i=0;i<tokens.size();++i)
+            tokens[i] = std::min(rates_[i], tokens[i] + elapsed * rates_[i]);
+        refill = now;
+
+        Message m;
+        while (ring_.pop(m))
+        {
+            handle(m, tokens);
+            handled_.fetch_add(1, std::memory_order_release);
+        }
+        if (stopping || now - lastReport >= kRepeatReport)
+        {
+            report_repeats();
+            lastReport = now;
+        }
+        if (stopping) return;
+        std::this_thread::sleep_for(kFlushInterval);
+    }
+}
+
+// Messages without an id number are told apart by their id name, then by their text. Texts are
+// keyed by a hash: they are long, and ones that embed handles are all distinct.
+static std::string key_of(int32_t id, std::string_view idName, std::string_view text)
+{
+    if (id) return "id " + std::to_string(id);
+    if (!idName.empty()) return "name " + std::string(idName);
+    return "text " + std::to_string(std::hash<std::string_view>{}(text));
+}
+
+static std::string label_of(int32_t id, std::string_view idName, std::string_view text)
+{
+    static constexpr size_t kExcerpt = 80;
+    if (id) return idName.empty() ? std::to_string(id) : std::string(idName) + " (" + std::to_string(id) + ")";
+    if (!idName.empty()) return std::string(idName);
+    return text.size() > kExcerpt ? std::string(text.substr(0, kExcerpt)) + "..." : std::string(text);
+}
+
+void DebugSink::handle(const Message& m, std::array<double, 4>& tokens)
+{
+    std::string key = key_of(m.id, m.idName, m.text);
+    if (const auto it = seen_.find(key); it != seen_.end())
+    {
+        ++it->second.unreported;
+        repeats_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // A first occurrence that is not printed is not remembered either: its next occurrence is a
+    // first one again, rather than a repeat of a message nobody saw.
+    if (tokens[m.severity] < 1.0)
+    {
+        rateLimited_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    tokens[m.severity] -= 1.0;
+    out_ << "validation [" << severity_name(m.severity) << "]: " << m.text << "\n";
+    if (seen_.size() < kMaxSeen) seen_.emplace(std::move(key), Seen{ label_of(m.id, m.idName, m.text), 0 });
+}
+
+void DebugSink::report_repeats()
+{
+    for (auto& [key, seen] : seen_)
+    {
+        if (!seen.unreported) continue;
+        out_ << "validation: " << seen.label << " repeated " << seen.unreported << " more times\n";
+        seen.unreported = 0;
+    }
+}
+
+} // namespace vkmini
@@ -0,0 +1,192 @@
+#include "debug_sink.hpp"
+#include "mpsc_queue.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace vkmini {
+
+static constexpr uint32_t kProducers = 4;
+
+static size_t count(std::string_view text, std::string_view what)
+{
+    size_t n = 0;
+    for (size_t p = text.find(what); p != std::string_view::npos; p = text.find(what, p + what.size())) ++n;
+    return n;
+}
+
+// Sum of the counts on "... repeated N more times" lines.
+static uint64_t reported_repeats(const std::string& out)
+{
+    uint64_t sum = 0;
+    constexpr std::string_view key = " repeated ";
+    for (size_t p = out.find(key); p != std::string::npos; p = out.find(key, p + key.size()))
+        sum += std::strtoull(out.c_str() + p + key.size(), nullptr, 10);
+    return sum;
+}
+
+// Each check returns an error message, or null when the queue or sink behaved.
+static const char* check_queue_producers(uint32_t items)
+{
+    struct Item { uint32_t producer, seq; };
+    MpscQueue<Item, 1024> q;
+    std::vector<std::thread> producers;
+    for (uint32_t p=0;p<kProducers;++p)
+        producers.emplace_back([&q, p, items] {
+            for (uint32_t i=0;i<items;++i)
+                while (!q.push([&](Item& it) { it = Item{ p, i }; })) std::this_thread::yield();
+        });
+
+    // Each producer's items arrive in order, once each.
+    std::vector<uint32_t> next(kProducers, 0);
+    const char* error = nullptr;
+    for (uint64_t received = 0; received < uint64_t(kProducers) * items;)
+    {
+        Item it;
+        if (!q.pop(it)) { std::this_thread::yield(); continue; }
+        if (!error && (it.producer >= kProducers || it.seq != next[it.producer]))
+            error = "queue: an item was lost, duplicated or reordered";
+        if (it.producer < kProducers) next[it.producer] = it.seq + 1;
+        ++received;
+    }
+    for (auto& t : producers) t.join();
+    Item extra;
+    if (!error && q.pop(extra)) error = "queue: more items than were pushed";
+    return error;
+}
+
+static const char* check_queue_full()
+{
+    MpscQueue<uint32_t, 8> q;
+    for (uint32_t i=0;i<8;++i)
+        if (!q.push([&](uint32_t& v) { v = i; })) return "queue: refused a push with room left";
+    if (q.push([](uint32_t& v) { v = 99; })) return "queue: accepted a push when full";
+    uint32_t v = 0;
+    if (!q.pop(v) || v != 0 || !q.push([](uint32_t& x) { x = 8; })) return "queue: no room after a pop";
+    for (uint32_t i=1;i<=8;++i)
+        if (!q.pop(v) || v != i) return "queue: items out of order after wrapping";
+    return q.pop(v) ? "queue: popped from an empty queue" : nullptr;
+}
+
+static const char* check_folding()
+{
+    std::ostringstream out;
+    DebugMessageStats st;
+    {
+        DebugSink sink(out, { 1000, 1000, 1000, 1000 });
+        for (const char* text : { "by id 1", "by id 2", "by id 3" })
+            sink.post(DebugSeverity::Warning, false, 7, "Id-Seven", text);
+        sink.post(DebugSeverity::Warning, false, 8, "Id-Seven", "other id");
+        for (const char* text : { "by name 1", "by name 2", "by name 3" })
+            sink.post(DebugSeverity::Error, true, 0, "VUID-Named", text);
+        for (int i=0;i<3;++i) sink.post(DebugSeverity::Info, false, 0, nullptr, "by text");
+        sink.post(DebugSeverity::Info, false, 0, nullptr, "by other text");
+        sink.flush();
+        st = sink.stats();
+    }
+    const std::string s = out.str();
+    if (count(s, "validation [") != 5) return "folding: wrong number of messages printed";
+    if (st.repeats != 6 || st.warnings != 4 || st.errors != 3 || st.info != 4 || st.performance != 3)
+        return "folding: wrong stats";
+    if (count(s, "Id-Seven (7) repeated 2 more times") != 1 || count(s, "VUID-Named repeated 2 more times") != 1 ||
+        count(s, "by text repeated 2 more times") != 1)
+        return "folding: repeats not reported by id, name and text";
+    return nullptr;
+}
+
+static const char* check_rate_limit()
+{
+    constexpr double kRate = 20;
+    constexpr uint32_t kPosted = 30;
+    std::ostringstream out;
+    std::vector<std::string> texts;
+    for (uint32_t i=0;i<kPosted;++i) texts.push_back("limited " + std::to_string(i) + ";");
+    DebugMessageStats st;
+    double seconds = 0;
+    std::string limited;
+    {
+        DebugSink sink(out, { kRate, kRate, kRate, kRate });
+        const auto t0 = std::chrono::steady_clock::now();
+        for (uint32_t i=0;i<kPosted;++i) sink.post(DebugSeverity::Verbose, false, int32_t(100 + i), nullptr, texts[i].c_str());
+        sink.flush();
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        // A limited first occurrence is not remembered: posted again once tokens are back, it is
+        // printed, and only its later repeats are folded.
+        for (uint32_t i=0;i<kPosted && limited.empty();++i)
+            if (out.str().find(texts[i]) == std::string::npos) limited = texts[i];
+        if (limited.empty()) return "rate limit: every first occurrence was printed";
+        const int32_t id = int32_t(100 + std::stoi(limited.substr(8)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        sink.post(DebugSeverity::Verbose, false, id, nullptr, limited.c_str());
+        sink.post(DebugSeverity::Verbose, false, id, nullptr, limited.c_str());
+        sink.flush();
+        st = sink.stats();
+    }
+    const std::string s = out.str();
+    const uint64_t printedFirst = kPosted - (st.rateLimited);
+    if (printedFirst < kRate || printedFirst > kRate + seconds * kRate + 1) return "rate limit: burst not limited to the rate";
+    if (count(s, limited) != 1 || st.repeats != 1 || reported_repeats(s) != 1)
+        return "rate limit: a limited message was folded before it was printed";
+    return nullptr;
+}
+
+static const char* check_sink_producers(uint32_t messages, double& nsPerPost)
+{
+    std::ostringstream out;
+    DebugMessageStats st;
+    uint64_t postNs = 0;
+    {
+        DebugSink sink(out);
+        std::vector<std::thread> producers;
+        std::vector<uint64_t> ns(kProducers);
+        for (uint32_t p=0;p<kProducers;++p)
+            producers.emplace_back([&, p] {
+                const auto t0 = std::chrono::steady_clock::now();
+                for (uint32_t i=0;i<messages;++i)
+                    sink.post(DebugSeverity(i % 4), i % 5 == 0, int32_t(1 + i % 64), "VUID-Flood", "flooded message");
+                ns[p] = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+            });
+        for (auto& t : producers) t.join();
+        for (uint64_t v : ns) postNs += v;
+        sink.flush();
+        st = sink.stats();
+    }
+    const uint64_t total = uint64_t(kProducers) * messages;
+    nsPerPost = double(postNs) / double(total);
+
+    // Every message is counted once, and either dropped or written: printed, folded or limited.
+    const std::string s = out.str();
+    if (st.errors + st.warnings + st.info + st.verbose != total) return "sink: messages miscounted";
+    if (st.performance != uint64_t(kProducers) * ((messages + 4) / 5)) return "sink: performance messages miscounted";
+    if (count(s, "validation [") + st.repeats + st.rateLimited + st.dropped != total) return "sink: messages lost or duplicated";
+    if (reported_repeats(s) != st.repeats) return "sink: folded repeats not reported";
+    if (total > 64 * 256 && !st.dropped) return "sink: a flood filled no ring slots to drop";
+    return nullptr;
+}
+
+int run_debug_sink_bench(uint32_t messages)
+{
+    std::cout << "[vkmini] Debug sink bench: " << messages << " messages per producer, " << kProducers << " producers\n";
+    double nsPerPost = 0;
+    bool ok = true;
+    for (const char* error : { check_queue_producers(messages), check_queue_full(), check_folding(),
+                               check_rate_limit(), check_sink_producers(messages, nsPerPost) })
+    {
+        if (!error) continue;
+        std::cerr << "[vkmini] Debug sink bench: " << error << "\n";
+        ok = false;
+    }
+    char line[120];
+    std::snprintf(line, sizeof(line), "  post  %8.1f ns/message (%u threads, ring full most of the time)\n", nsPerPost, kProducers);
+    std::cout << line;
+    return ok ? 0 : 1;
+}
+
+} // namespace vkmini
@@ -0,0 +1,122 @@
+#include "jobs.hpp"
+#include "microbench.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace vkmini {
+
+static constexpr uint32_t kChainLength = 64;
+static constexpr size_t kForGrain = 4096;
+
+// Each check returns an error message, or null when the scheduler behaved.
+static const char* check_fan_out(JobSystem& js, uint32_t jobs)
+{
+    std::atomic<uint32_t> ran{0};
+    JobCounter c;
+    for (uint32_t i=0;i<jobs;++i) js.run(&c, [&] { ran.fetch_add(1, std::memory_order_relaxed); });
+    js.wait(c);
+    return ran.load() == jobs ? nullptr : "fan-out lost jobs";
+}
+
+static const char* check_chain(JobSystem& js)
+{
+    // Every link only starts after the previous one has finished, whichever thread ran it.
+    std::vector<uint32_t> order;
+    std::vector<JobCounter> links(kChainLength);
+    js.run(&links[0], [&] { order.push_back(0); });
+    for (uint32_t i=1;i<kChainLength;++i)
+        js.run_after(links[i - 1], &links[i], [&order, i] { order.push_back(i); });
+    js.wait(links.back());
+
+    std::vector<uint32_t> expected(kChainLength);
+    std::iota(expected.begin(), expected.end(), 0u);
+    return order == expected ? nullptr : "dependency chain ran out of order";
+}
+
+static const char* check_nested(JobSystem& js, uint32_t jobs)
+{
+    // Jobs that wait on jobs they spawned: must not deadlock even with every thread waiting.
+    const uint32_t outer = std::max(1u, js.threads() * 2);
+    const uint32_t inner = std::max(1u, jobs / outer);
+    std::atomic<uint32_t> ran{0};
+    JobCounter c;
+    for (uint32_t i=0;i<outer;++i)
+        js.run(&c, [&] {
+            JobCounter nested;
+            for (uint32_t k=0;k<inner;++k) js.run(&nested, [&] { ran.fetch_add(1, std::memory_order_relaxed); });
+            js.wait(nested);
+        });
+    js.wait(c);
+    return ran.load() == outer * inner ? nullptr : "nested waits lost jobs";
+}
+
+static const char* check_errors(JobSystem& js)
+{
+    // A throwing job surfaces from wait() and skips the jobs scheduled after its counter.
+    JobCounter first, second;
+    std::atomic<bool> ranAfter{false};
+    js.run(&first, [] { throw std::runtime_error("expected"); });
+    js.run_after(first, &second, [&] { ranAfter = true; });
+    bool threw = false;
+    try { js.wait(second); }
+    catch (const std::runtime_error&) { threw = true; }
+    js.drain(first);
+    return threw && !ranAfter ? nullptr : "job exception was not propagated";
+}
+
+static const char* check_parallel_for(JobSystem& js, uint32_t jobs)
+{
+    const size_t n = size_t(jobs) * 64;
+    std::vector<uint32_t> v(n, 1);
+    std::atomic<uint64_t> sum{0};
+    js.parallel_for(n, kForGrain, [&](size_t begin, size_t end) {
+        uint64_t local = 0;
+        for (size_t i=begin;i<end;++i) local += v[i];
+        sum.fetch_add(local, std::memory_order_relaxed);
+    });
+    return sum.load() == n ? nullptr : "parallel_for missed items";
+}
+
+int run_job_bench(uint32_t jobs)
+{
+    std::vector<uint32_t> counts;
+    const uint32_t hw = std::max(1u, std::thread::hardware_concurrency());
+    for (uint32_t t=1;t<hw;t*=2) counts.push_back(t);
+    counts.push_back(hw);
+
+    std::cout << "[vkmini] Job bench: " << jobs << " jobs per run\n";
+    bool ok = true;
+    for (uint32_t t : counts)
+    {
+        JobSystem js(t - 1);
+        for (const char* error : { check_fan_out(js, jobs), check_chain(js), check_nested(js, jobs),
+                                   check_errors(js), check_parallel_for(js, jobs) })
+        {
+            if (!error) continue;
+            std::cerr << "[vkmini] Job bench: " << t << " threads: " << error << "\n";
+            ok = false;
+        }
+
+        std::atomic<uint32_t> sink{0};
+        const double fanOut = time_runs([&] {
+            JobCounter c;
+            for (uint32_t i=0;i<jobs;++i) js.run(&c, [&] { sink.fetch_add(1, std::memory_order_relaxed); });
+            js.wait(c);
+        }).medianMs;
+        const double nested = time_runs([&] { check_nested(js, jobs); }).medianMs;
+
+        char line[160];
+        std::snprintf(line, sizeof(line), "  %2u thread%s  fan-out %8.3f ms (%6.1f Mjobs/s)  nested %8.3f ms\n",
+            t, t == 1 ? " " : "s", fanOut, jobs / (fanOut * 1000.0), nested);
+        std::cout << line;
+    }
+    return ok ? 0 : 1;
+}
+
+} // namespace vkmini
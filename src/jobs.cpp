@@ -0,0 +1,222 @@
+#include "jobs.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace vkmini {
+
+// Which deque the calling thread pushes to and pops from first: its own for a worker of `owner`,
+// the shared one for every other thread.
+static thread_local const JobSystem* tlsOwner = nullptr;
+static thread_local uint32_t tlsQueue = 0;
+
+JobSystem::JobSystem(uint32_t workers)
+{
+    if (workers == kAutoWorkers)
+        workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+    queues_.reserve(workers + 1);
+    for (uint32_t i=0;i<=workers;++i) queues_.push_back(std::make_unique<Queue>());
+    workers_.reserve(workers);
+    for (uint32_t i=1;i<=workers;++i)
+        workers_.emplace_back([this, i] { worker(i); });
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard lock(sleepM_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+void JobSystem::run(JobCounter* counter, std::function<void()> fn)
+{
+    if (counter) counter->pending_.fetch_add(1, std::memory_order_relaxed);
+    push(Job{ std::move(fn), counter });
+}
+
+void JobSystem::run_after(JobCounter& dependency, JobCounter* counter, std::function<void()> fn)
+{
+    if (counter) counter->pending_.fetch_add(1, std::memory_order_relaxed);
+    Job job{ std::move(fn), counter };
+    std::exception_ptr error;
+    {
+        // finish() drains continuations under the same lock after the count reaches zero, so the
+        // job is either appended before that drain or sees zero here.
+        std::lock_guard lock(dependency.m_);
+        if (dependency.pending_.load(std::memory_order_acquire) != 0)
+        {
+            dependency.continuations_.push_back(std::move(job));
+            return;
+        }
+        error = dependency.error_;
+    }
+    if (error) skip(job, error);
+    else push(std::move(job));
+}
+
+void JobSystem::push(Job job)
+{
+    Queue& q = *queues_[tlsOwner == this ? tlsQueue : 0];
+    {
+        std::lock_guard lock(q.m);
+        q.jobs.push_back(std::move(job));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    { std::lock_guard lock(sleepM_); } // no sleeper can miss the count between its check and its wait
+    wake_.notify_one();
+}
+
+bool JobSystem::try_pop(Job& out)
+{
+    if (queued_.load(std::memory_order_acquire) == 0) return false;
+
+    const uint32_t self = tlsOwner == this ? tlsQueue : 0;
+    {
+        Queue& q = *queues_[self];
+        std::lock_guard lock(q.m);
+        if (!q.jobs.empty())
+        {
+            out = std::move(q.jobs.back());
+            q.jobs.pop_back();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    const uint32_t n = uint32_t(queues_.size());
+    for (uint32_t k=1;k<n;++k)
+    {
+        Queue& q = *queues_[(self + k) % n];
+        std::lock_guard lock(q.m);
+        if (!q.jobs.empty())
+        {
+            out = std::move(q.jobs.front());
+            q.jobs.pop_front();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(Job& job)
+{
+    try { job.fn(); }
+    catch (...)
+    {
+        if (job.counter)
+        {
+            std::lock_guard lock(job.counter->m_);
+            if (!job.counter->error_) job.counter->error_ = std::current_exception();
+        }
+    }
+    job.fn = nullptr; // release captures before the counter can signal
+    finish(job.counter);
+}
+
+void JobSystem::skip(Job& job, std::exception_ptr error)
+{
+    if (job.counter)
+    {
+        std::lock_guard lock(job.counter->m_);
+        if (!job.counter->error_) job.counter->error_ = error;
+    }
+    finish(job.counter);
+}
+
+void JobSystem::finish(JobCounter* counter)
+{
+    if (!counter) return;
+
+    // Only the final decrement takes the lock: it has to hand the continuations over atomically
+    // with reaching zero, and drain() takes the same lock before letting the counter go out of scope.
+    uint32_t pending = counter->pending_.load(std::memory_order_relaxed);
+    while (pending > 1)
+        if (counter->pending_.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel))
+            return;
+
+    std::vector<Job> next;
+    std::exception_ptr error;
+    {
+        std::lock_guard lock(counter->m_);
+        if (counter->pending_.fetch_sub(1, std::memory_order_acq_rel) != 1) return; // rescheduled meanwhile
+        next.swap(counter->continuations_);
+        error = counter->error_;
+    }
+    // Wake waiters before the continuations: the counter's owner may be sleeping on it.
+    { std::lock_guard lock(sleepM_); }
+    wake_.notify_all();
+    for (auto& job : next)
+    {
+        if (error) skip(job, error);
+        else push(std::move(job));
+    }
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    drain(counter);
+    std::lock_guard lock(counter.m_);
+    if (auto error = std::exchange(counter.error_, nullptr))
+        std::rethrow_exception(error);
+}
+
+void JobSystem::drain(JobCounter& counter) noexcept
+{
+    while (!counter.done())
+    {
+        Job job;
+        if (try_pop(job))
+        {
+            execute(job);
+            continue;
+        }
+        std::unique_lock lock(sleepM_);
+        wake_.wait(lock, [&] { return counter.done() || queued_.load(std::memory_order_acquire) != 0; });
+    }
+    std::lock_guard lock(counter.m_); // the last finish() is out of the counter
+}
+
+void JobSystem::parallel_for(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& fn)
+{
+    const size_t chunks = std::clamp<size_t>(count / std::max<size_t>(grain, 1), 1, threads());
+    if (chunks == 1)
+    {
+        if (count) fn(0, count);
+        return;
+    }
+
+    const size_t chunk = (count + chunks - 1) / chunks;
+    ScopedJobs group(*this);
+    for (size_t begin=chunk;begin<count;begin+=chunk)
+    {
+        const size_t end = std::min(count, begin + chunk);
+        group.run([&fn, begin, end] { fn(begin, end); });
+    }
+    fn(0, chunk);
+    group.wait();
+}
+
+void JobSystem::worker(uint32_t index)
+{
+    tlsOwner = this;
+    tlsQueue = index;
+    VKMINI_TRACE_THREAD_NAME("job worker");
+    for (;;)
+    {
+        Job job;
+        if (try_pop(job))
+        {
+            execute(job);
+            continue;
+        }
+        std::unique_lock lock(sleepM_);
+        wake_.wait(lock, [&] { return stop_ || queued_.load(std::memory_order_acquire) != 0; });
+        if (stop_) return;
+    }
+}
+
+} // namespace vkmini
@@ -1,20 +1,55 @@
 #include "vk_app.hpp"
+#include "app_options.hpp"
 #include "platform.hpp"
 #include <iostream>
 
-int main()
+int main(int argc, char** argv)
 {
+    using namespace vkmini;
+    AppOptions opts{};
+    try { opts = parse_options(argc, argv); }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+
+    if (opts.resizeReplay)
+        return run_resize_replay();
+
+    if (opts.headless)
+    {
+        VkApp app{};
+        try { return app.run_headless(opts); }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Fatal: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
 #if VKMINI_HEADLESS
-    std::cout << "[vkmini] Headless build: no window/swapchain.\n";
     return 0;
 #else
-    using namespace vkmini;
     WindowCreateInfo ci{};
     ci.title = "vk_cross_platform_default";
-    if (auto* wnd = create_platform_window(ci))
+    ci.width = opts.width;
+    ci.height = opts.height;
+    ci.resizeDebounceMs = opts.resizeDebounceMs;
+    ci.headlessSurface = opts.headlessSurface;
+    ci.script = opts.windowScript;
+    IPlatformWindow* wnd = nullptr;
+    try { wnd = create_platform_window(ci); }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+    if (wnd)
     {
         VkApp app{};
-        try { app.run(*wnd); }
+        int rc = 0;
+        try { rc = app.run(*wnd, opts); }
         catch (const std::exception& e)
         {
             std::cerr << "Fatal: " << e.what() << "\n";
@@ -22,7 +57,7 @@ int main()
             return 1;
         }
         destroy_platform_window(wnd);
-        return 0;
+        return rc;
     }
     std::cerr << "Failed to create platform window.\n";
     return 1;
@@ -1,8 +1,120 @@
 #include "math.hpp"
 #include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+// Kernel selection happens at compile time from the target ISA flags
+// (see VKMINI_MATH_AVX2 in CMakeLists.txt). Define VKMINI_MATH_FORCE_SCALAR to opt out.
+#if !defined(VKMINI_MATH_FORCE_SCALAR) && defined(__AVX2__)
+    #define VKMINI_MATH_USE_AVX2 1
+    #include <immintrin.h>
+#elif !defined(VKMINI_MATH_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define VKMINI_MATH_USE_SSE2 1
+    #include <emmintrin.h>
+#endif
 
 namespace vkmini {
 
+namespace {
+
+// All kernels compute r = a * b for column-major matrices: column c of r is
+// sum_k a.col(k) * b[k + c*4]. Every column of a is loaded before r is written,
+// and column c of b is read before column c of r is stored, so r may alias a or b.
+
+#if VKMINI_MATH_USE_AVX2
+
+struct ACols { __m256 c0, c1, c2, c3; };
+
+inline ACols load_a(const float* a)
+{
+    // Each column of a duplicated into both 128-bit lanes; two result columns per iteration.
+    return ACols{
+        _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 0)),
+        _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4)),
+        _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8)),
+        _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12)) };
+}
+
+inline __m256 madd(__m256 x, __m256 y, __m256 acc)
+{
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(x, y, acc);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(x, y), acc);
+#endif
+}
+
+inline void mul_kernel(const ACols& a, const float* b, float* r)
+{
+    const __m256 b01 = _mm256_loadu_ps(b + 0);
+    const __m256 b23 = _mm256_loadu_ps(b + 8);
+
+    __m256 r01 = _mm256_mul_ps(a.c0, _mm256_shuffle_ps(b01, b01, 0x00));
+    __m256 r23 = _mm256_mul_ps(a.c0, _mm256_shuffle_ps(b23, b23, 0x00));
+    r01 = madd(a.c1, _mm256_shuffle_ps(b01, b01, 0x55), r01);
+    r23 = madd(a.c1, _mm256_shuffle_ps(b23, b23, 0x55), r23);
+    r01 = madd(a.c2, _mm256_shuffle_ps(b01, b01, 0xAA), r01);
+    r23 = madd(a.c2, _mm256_shuffle_ps(b23, b23, 0xAA), r23);
+    r01 = madd(a.c3, _mm256_shuffle_ps(b01, b01, 0xFF), r01);
+    r23 = madd(a.c3, _mm256_shuffle_ps(b23, b23, 0xFF), r23);
+
+    _mm256_storeu_ps(r + 0, r01);
+    _mm256_storeu_ps(r + 8, r23);
+}
+
+constexpr const char* kBackend = "avx2";
+
+#elif VKMINI_MATH_USE_SSE2
+
+struct ACols { __m128 c0, c1, c2, c3; };
+
+inline ACols load_a(const float* a)
+{
+    return ACols{ _mm_loadu_ps(a + 0), _mm_loadu_ps(a + 4), _mm_loadu_ps(a + 8), _mm_loadu_ps(a + 12) };
+}
+
+inline void mul_kernel(const ACols& a, const float* b, float* r)
+{
+    for (int c=0;c<4;++c)
+    {
+        const __m128 bc = _mm_loadu_ps(b + c*4);
+        __m128 v = _mm_mul_ps(a.c0, _mm_shuffle_ps(bc, bc, 0x00));
+        v = _mm_add_ps(v, _mm_mul_ps(a.c1, _mm_shuffle_ps(bc, bc, 0x55)));
+        v = _mm_add_ps(v, _mm_mul_ps(a.c2, _mm_shuffle_ps(bc, bc, 0xAA)));
+        v = _mm_add_ps(v, _mm_mul_ps(a.c3, _mm_shuffle_ps(bc, bc, 0xFF)));
+        _mm_storeu_ps(r + c*4, v);
+    }
+}
+
+constexpr const char* kBackend = "sse2";
+
+#else
+
+struct ACols { std::array<float,16> m; };
+
+inline ACols load_a(const float* a)
+{
+    ACols r{};
+    for (int i=0;i<16;++i) r.m[i] = a[i];
+    return r;
+}
+
+inline void mul_kernel(const ACols& a, const float* b, float* r)
+{
+    for (int col=0;col<4;++col)
+    {
+        const float b0=b[col*4+0], b1=b[col*4+1], b2=b[col*4+2], b3=b[col*4+3];
+        for (int row=0;row<4;++row)
+            r[row + col*4] = a.m[row]*b0 + a.m[row+4]*b1 + a.m[row+8]*b2 + a.m[row+12]*b3;
+    }
+}
+
+constexpr const char* kBackend = "scalar";
+
+#endif
+
+} // namespace
+
 Mat4 identity()
 {
     Mat4 r{};
@@ -51,14 +163,28 @@ Mat4 rotate_y(float rads)
 Mat4 mul(const Mat4& a, const Mat4& b)
 {
     Mat4 r{};
-    for(int row=0;row<4;++row)
-    for(int col=0;col<4;++col)
-    {
-        float v=0;
-        for(int k=0;k<4;++k) v += a.m[row + k*4] * b.m[k + col*4];
-        r.m[row + col*4] = v;
-    }
+    mul_kernel(load_a(a.m.data()), b.m.data(), r.m.data());
     return r;
 }
 
+void mul_batch(const Mat4& a, std::span<const Mat4> b, std::span<Mat4> out)
+{
+    if (out.size() < b.size()) throw std::invalid_argument("mul_batch: output span too small");
+
+    const ACols ac = load_a(a.m.data());
+    for (std::size_t i=0;i<b.size();++i)
+        mul_kernel(ac, b[i].m.data(), out[i].m.data());
+}
+
+void mul_batch(std::span<const Mat4> a, std::span<const Mat4> b, std::span<Mat4> out)
+{
+    if (a.size() != b.size()) throw std::invalid_argument("mul_batch: input spans differ in size");
+    if (out.size() < b.size()) throw std::invalid_argument("mul_batch: output span too small");
+
+    for (std::size_t i=0;i<b.size();++i)
+        mul_kernel(load_a(a[i].m.data()), b[i].m.data(), out[i].m.data());
+}
+
+const char* math_backend() { return kBackend; }
+
 } // namespace vkmini
@@ -0,0 +1,145 @@
+#include "math.hpp"
+#include "microbench.hpp"
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace vkmini {
+
+// Plain scalar loop: what every kernel set must agree with, and the speed they must beat.
+static Mat4 reference_mul(const Mat4& a, const Mat4& b)
+{
+    Mat4 r{};
+    for (int col=0;col<4;++col)
+        for (int row=0;row<4;++row)
+        {
+            float sum = 0.0f;
+            for (int k=0;k<4;++k) sum += a.m[row + k*4] * b.m[k + col*4];
+            r.m[row + col*4] = sum;
+        }
+    return r;
+}
+
+// Entries of the inputs are in [-1, 1], so products of four terms stay near 1; FMA and the
+// summation order only move the last bits.
+static bool near(const Mat4& x, const Mat4& ref)
+{
+    for (int i=0;i<16;++i)
+        if (std::abs(x.m[i] - ref.m[i]) > 1e-5f * (1.0f + std::abs(ref.m[i]))) return false;
+    return true;
+}
+
+static std::vector<Mat4> random_matrices(uint32_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> v(-1.0f, 1.0f);
+    std::vector<Mat4> out(count);
+    for (Mat4& m : out)
+        for (float& f : m.m) f = v(rng);
+    return out;
+}
+
+static void report(const char* what, uint32_t matrices, const BenchTiming& t)
+{
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-24s min %8.3f ms  median %8.3f ms  %7.2f ns/matrix\n",
+        what, t.minMs, t.medianMs, t.medianMs * 1e6 / matrices);
+    std::cout << line;
+}
+
+// Each check returns an error message, or null when the kernels agree with the reference.
+static const char* check_kernels(const std::vector<Mat4>& a, const std::vector<Mat4>& b)
+{
+    const size_t n = a.size();
+    for (size_t i=0;i<n;++i)
+        if (!near(mul(a[i], b[i]), reference_mul(a[i], b[i]))) return "mul: differs from the scalar reference";
+
+    std::vector<Mat4> out(n);
+    mul_batch(a[0], b, out);
+    for (size_t i=0;i<n;++i)
+        if (!near(out[i], reference_mul(a[0], b[i]))) return "mul_batch(a, b[]): differs from the scalar reference";
+    mul_batch(a, b, out);
+    for (size_t i=0;i<n;++i)
+        if (!near(out[i], reference_mul(a[i], b[i]))) return "mul_batch(a[], b[]): differs from the scalar reference";
+
+    // out may alias either input.
+    std::vector<Mat4> inPlace = b;
+    mul_batch(a[0], inPlace, inPlace);
+    for (size_t i=0;i<n;++i)
+        if (!near(inPlace[i], reference_mul(a[0], b[i]))) return "mul_batch(a, b[]): wrong when out aliases b";
+    inPlace = a;
+    mul_batch(inPlace, b, inPlace);
+    for (size_t i=0;i<n;++i)
+        if (!near(inPlace[i], reference_mul(a[i], b[i]))) return "mul_batch(a[], b[]): wrong when out aliases a";
+    return nullptr;
+}
+
+static const char* check_sizes(const std::vector<Mat4>& a, const std::vector<Mat4>& b)
+{
+    const auto throws = [](auto&& fn) {
+        try { fn(); }
+        catch (const std::invalid_argument&) { return true; }
+        return false;
+    };
+    std::vector<Mat4> out(b.size());
+    const std::span<const Mat4> shortB(b.data(), b.size() - 1);
+    const std::span<Mat4> shortOut(out.data(), out.size() - 1);
+    if (!throws([&] { mul_batch(a, shortB, out); })) return "mul_batch(a[], b[]): inputs of different sizes accepted";
+    if (!throws([&] { mul_batch(a, b, shortOut); })) return "mul_batch(a[], b[]): short output accepted";
+    if (!throws([&] { mul_batch(a[0], b, shortOut); })) return "mul_batch(a, b[]): short output accepted";
+    if (throws([&] { mul_batch(a[0], shortB, out); })) return "mul_batch(a, b[]): longer output rejected";
+    return nullptr;
+}
+
+// The instance transforms are translate(p) * spin. spin has no translation, so the product is
+// spin with p in its translation column: what update_uniforms writes instead of multiplying.
+static const char* check_instance_shortcut(const std::vector<Mat4>& positions)
+{
+    const Mat4 spin = mul(rotate_y(0.9f), rotate_x(0.9f * 0.7f));
+    for (const Mat4& p : positions)
+    {
+        Mat4 shortcut = spin;
+        shortcut.m[12] = p.m[0]; shortcut.m[13] = p.m[1]; shortcut.m[14] = p.m[2];
+        if (!near(shortcut, reference_mul(translate(p.m[0], p.m[1], p.m[2]), spin)))
+            return "instance transforms: translation shortcut differs from translate * spin";
+    }
+    return nullptr;
+}
+
+int run_math_bench(uint32_t matrices)
+{
+    std::cout << "[vkmini] Math bench: " << matrices << " matrices, " << math_backend() << " kernels\n";
+    const std::vector<Mat4> a = random_matrices(matrices + 1, 1), b = random_matrices(matrices + 1, 2);
+    bool ok = true;
+    for (const char* error : { check_kernels(a, b), check_sizes(a, b), check_instance_shortcut(a) })
+    {
+        if (!error) continue;
+        std::cerr << "[vkmini] Math bench: " << error << "\n";
+        ok = false;
+    }
+
+    std::vector<Mat4> out(a.size());
+    volatile float sink = 0.0f; // keeps the loops from being optimized away
+    report("scalar reference", matrices, time_runs([&] {
+        for (uint32_t i=0;i<matrices;++i) out[i] = reference_mul(a[i], b[i]);
+        sink = out[matrices - 1].m[0];
+    }));
+    report("mul", matrices, time_runs([&] {
+        for (uint32_t i=0;i<matrices;++i) out[i] = mul(a[i], b[i]);
+        sink = out[matrices - 1].m[0];
+    }));
+    report("mul_batch(a, b[])", matrices, time_runs([&] {
+        mul_batch(a[0], std::span(b).first(matrices), out);
+        sink = out[matrices - 1].m[0];
+    }));
+    report("mul_batch(a[], b[])", matrices, time_runs([&] {
+        mul_batch(std::span(a).first(matrices), std::span(b).first(matrices), out);
+        sink = out[matrices - 1].m[0];
+    }));
+    return ok ? 0 : 1;
+}
+
+} // namespace vkmini
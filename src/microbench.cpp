@@ -0,0 +1,27 @@
+#include "microbench.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace vkmini {
+
+static constexpr double kBenchMinSeconds = 0.25; // per configuration
+static constexpr uint32_t kBenchMinRuns = 10;
+
+BenchTiming time_runs(const std::function<void()>& fn)
+{
+    std::vector<double> ms;
+    const auto start = std::chrono::steady_clock::now();
+    while (ms.size() < kBenchMinRuns
+        || std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < kBenchMinSeconds)
+    {
+        const auto t0 = std::chrono::steady_clock::now();
+        fn();
+        ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+    }
+    std::sort(ms.begin(), ms.end());
+    return BenchTiming{ ms.front(), ms[ms.size() / 2] };
+}
+
+} // namespace vkmini
@@ -13,9 +13,12 @@ void destroy_android_window(IPlatformWindow*);
 IPlatformWindow* create_xcb_window(const WindowCreateInfo&);
 void destroy_xcb_window(IPlatformWindow*);
 #endif
+IPlatformWindow* create_headless_window(const WindowCreateInfo&);
 
 IPlatformWindow* create_platform_window(const WindowCreateInfo& ci)
 {
+    if (ci.headlessSurface)
+        return create_headless_window(ci);
 #if defined(_WIN32)
     return create_win32_window(ci);
 #elif defined(__ANDROID__)
@@ -25,8 +28,31 @@ IPlatformWindow* create_platform_window(const WindowCreateInfo& ci)
 #endif
 }
 
+void ResizeCoalescer::configure(FramebufferSize size)
+{
+    pending_ = size;
+    hasPending_ = true;
+    ++events_;
+}
+
+void ResizeCoalescer::end_pump(Clock::time_point now)
+{
+    if (!hasPending_) return;
+    hasPending_ = false;
+    if (pending_ == size_) return; // a move, or a drag that came back
+    size_ = pending_;
+    lastChange_ = now;
+    ++changes_;
+}
+
+bool ResizeCoalescer::settled(Clock::time_point now) const
+{
+    return changes_ == 0 || now - lastChange_ >= debounce_;
+}
+
 void destroy_platform_window(IPlatformWindow* wnd)
 {
+    // Every backend, the headless one included, is released through its virtual destructor.
 #if defined(_WIN32)
     destroy_win32_window(wnd);
 #elif defined(__ANDROID__)
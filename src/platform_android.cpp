@@ -11,7 +11,8 @@ public:
     NativeWindow native() const override { return {}; }
     FramebufferSize framebuffer_size() const override { return {}; }
     bool pump_events() override { return false; }
-    void wait_events() override {}
+    void wait_events(std::chrono::milliseconds) override {}
+    void wake() override {}
     bool is_minimized() const override { return true; }
     const char* platform_name() const override { return "android(stub)"; }
 };
@@ -0,0 +1,213 @@
+#include "platform.hpp"
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace vkmini {
+namespace {
+
+using Clock = ResizeCoalescer::Clock;
+
+struct ScriptStep {
+    enum class Action : uint8_t { Resize, Drag, Minimize, Restore, Quit };
+    std::chrono::milliseconds at{};
+    Action action = Action::Quit;
+    FramebufferSize size;               // Resize, Drag: target
+    std::chrono::milliseconds length{}; // Drag
+};
+
+[[noreturn]] static void bad_script(std::string_view step, std::string_view what)
+{
+    throw std::runtime_error("--window-script: '" + std::string(step) + "': " + std::string(what));
+}
+
+static std::vector<std::string_view> split(std::string_view s, char sep)
+{
+    std::vector<std::string_view> out;
+    while (!s.empty())
+    {
+        const size_t n = s.find(sep);
+        const std::string_view part = s.substr(0, n);
+        const size_t b = part.find_first_not_of(' ');
+        if (b != std::string_view::npos) out.push_back(part.substr(b, part.find_last_not_of(' ') - b + 1));
+        if (n == std::string_view::npos) break;
+        s.remove_prefix(n + 1);
+    }
+    return out;
+}
+
+static uint32_t number(std::string_view step, std::string_view s)
+{
+    uint32_t v = 0;
+    const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec != std::errc{} || end != s.data() + s.size()) bad_script(step, "expected a number, got '" + std::string(s) + "'");
+    return v;
+}
+
+static FramebufferSize extent(std::string_view step, std::string_view s)
+{
+    const size_t x = s.find('x');
+    if (x == std::string_view::npos) bad_script(step, "expected WxH");
+    const FramebufferSize size{ number(step, s.substr(0, x)), number(step, s.substr(x + 1)) };
+    if (!size.w || !size.h) bad_script(step, "width and height must be non-zero (use minimize)");
+    return size;
+}
+
+// "500 resize 800x600; 1000 drag 1920x1080 400; 2000 minimize; 2500 restore; 3000 quit": each step
+// is a time in milliseconds since the window was created, in order, then an action.
+static std::vector<ScriptStep> parse_script(std::string_view script)
+{
+    std::vector<ScriptStep> steps;
+    for (std::string_view text : split(script, ';'))
+    {
+        const auto words = split(text, ' ');
+        if (words.size() < 2) bad_script(text, "expected 'MS action'");
+        ScriptStep st;
+        st.at = std::chrono::milliseconds(number(text, words[0]));
+        if (!steps.empty() && st.at < steps.back().at) bad_script(text, "steps must be in time order");
+
+        const std::string_view action = words[1];
+        size_t args = 0;
+        if (action == "resize") { st.action = ScriptStep::Action::Resize; args = 1; }
+        else if (action == "drag") { st.action = ScriptStep::Action::Drag; args = 2; }
+        else if (action == "minimize") st.action = ScriptStep::Action::Minimize;
+        else if (action == "restore") st.action = ScriptStep::Action::Restore;
+        else if (action == "quit") st.action = ScriptStep::Action::Quit;
+        else bad_script(text, "unknown action '" + std::string(action) + "'");
+        if (words.size() != 2 + args) bad_script(text, "wrong number of arguments");
+
+        if (args >= 1) st.size = extent(text, words[2]);
+        if (args >= 2) st.length = std::chrono::milliseconds(number(text, words[3]));
+        steps.push_back(st);
+    }
+    return steps;
+}
+
+// A window without a window system: Vulkan presents to a VK_EXT_headless_surface, and the size
+// changes, minimizes and quits come from a script played against the wall clock instead of user
+// input. Drags send one configure per pump, so a scripted drag is a resize storm of the same shape
+// as one from XCB and goes through the same coalescing.
+class HeadlessWindow final : public IPlatformWindow {
+public:
+    explicit HeadlessWindow(const WindowCreateInfo& ci)
+        : resize_(FramebufferSize{ ci.width, ci.height }, std::chrono::milliseconds(ci.resizeDebounceMs))
+        , steps_(parse_script(ci.script))
+        , restored_(resize_.size())
+        , start_(Clock::now())
+    {}
+
+    NativeWindow native() const override
+    {
+        NativeWindow n{};
+        n.headless = true;
+        return n;
+    }
+    FramebufferSize framebuffer_size() const override { return resize_.size(); }
+
+    bool pump_events() override
+    {
+        const Clock::time_point now = Clock::now();
+        for (; next_ < steps_.size() && start_ + steps_[next_].at <= now; ++next_)
+            apply(steps_[next_]);
+        if (dragging_)
+        {
+            const ScriptStep& d = steps_[drag_];
+            const double t = d.length.count() ? std::min(1.0, std::chrono::duration<double, std::milli>(
+                now - (start_ + d.at)).count() / double(d.length.count())) : 1.0;
+            const auto lerp = [t](uint32_t a, uint32_t b) { return uint32_t(double(a) + (double(b) - double(a)) * t + 0.5); };
+            restored_ = FramebufferSize{ lerp(dragFrom_.w, d.size.w), lerp(dragFrom_.h, d.size.h) };
+            if (!minimized_) resize_.configure(restored_);
+            dragging_ = t < 1.0;
+        }
+        resize_.end_pump(now);
+        return !quit_;
+    }
+
+    void wait_events(std::chrono::milliseconds timeout) override
+    {
+        // Nothing happens between script steps, so sleep until the next one (or drag update), the
+        // timeout or wake(); with neither a step nor a timeout left, until wake().
+        constexpr auto kDragStep = std::chrono::milliseconds(10);
+        const Clock::time_point now = Clock::now();
+        Clock::time_point until = Clock::time_point::max();
+        if (dragging_) until = now + kDragStep;
+        else if (next_ < steps_.size()) until = start_ + steps_[next_].at;
+        if (timeout != kNoTimeout) until = std::min(until, now + timeout);
+        {
+            std::unique_lock lock(wakeMutex_);
+            if (until == Clock::time_point::max()) wakeCv_.wait(lock, [&] { return woken_; });
+            else wakeCv_.wait_until(lock, until, [&] { return woken_; });
+            woken_ = false;
+        }
+        pump_events();
+    }
+
+    void wake() override
+    {
+        {
+            std::lock_guard lock(wakeMutex_);
+            woken_ = true;
+        }
+        wakeCv_.notify_one();
+    }
+
+    bool is_minimized() const override { return resize_.minimized(); }
+    bool resize_settled() const override { return resize_.settled(Clock::now()); }
+    const char* platform_name() const override { return "headless"; }
+
+private:
+    void apply(const ScriptStep& st)
+    {
+        switch (st.action)
+        {
+        case ScriptStep::Action::Resize:
+            dragging_ = false;
+            restored_ = st.size;
+            if (!minimized_) resize_.configure(st.size);
+            break;
+        case ScriptStep::Action::Drag:
+            dragging_ = true;
+            drag_ = size_t(&st - steps_.data());
+            dragFrom_ = restored_;
+            break;
+        case ScriptStep::Action::Minimize:
+            minimized_ = true;
+            resize_.configure(FramebufferSize{});
+            break;
+        case ScriptStep::Action::Restore:
+            minimized_ = false;
+            resize_.configure(restored_);
+            break;
+        case ScriptStep::Action::Quit:
+            quit_ = true;
+            break;
+        }
+    }
+
+    ResizeCoalescer resize_;
+    std::vector<ScriptStep> steps_;
+    size_t next_ = 0;
+    FramebufferSize restored_;  // size outside of a minimize
+    bool minimized_ = false;
+    bool dragging_ = false;
+    size_t drag_ = 0;           // step of the active drag
+    FramebufferSize dragFrom_;
+    bool quit_ = false;
+    Clock::time_point start_;
+
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    bool woken_ = false; // wake() since the last wait_events()
+};
+
+} // namespace
+
+// Throws std::runtime_error on a malformed script.
+IPlatformWindow* create_headless_window(const WindowCreateInfo& ci) { return new HeadlessWindow(ci); }
+
+} // namespace vkmini
@@ -65,14 +65,16 @@ public:
         return alive_;
     }
 
-    void wait_events() override
+    void wait_events(std::chrono::milliseconds timeout) override
     {
-        MSG msg{};
-        GetMessageW(&msg, nullptr, 0, 0);
-        TranslateMessage(&msg);
-        DispatchMessageW(&msg);
+        MsgWaitForMultipleObjectsEx(0, nullptr, timeout == kNoTimeout ? INFINITE : DWORD(timeout.count()), QS_ALLINPUT,
+                                    MWMO_INPUTAVAILABLE);
+        pump_events();
     }
 
+    // WM_NULL does nothing but end the MsgWaitForMultipleObjects.
+    void wake() override { PostMessageW(hwnd_, WM_NULL, 0, 0); }
+
     bool is_minimized() const override { return minimized_ || fbw_ == 0 || fbh_ == 0; }
 
     const char* platform_name() const override { return "win32"; }
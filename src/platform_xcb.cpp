@@ -1,16 +1,39 @@
 #if !defined(_WIN32) && !defined(__ANDROID__)
 
-#include "platform.hpp"
-#include <xcb/xcb.h>
+#include "platform_xcb.hpp"
+#include <poll.h>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <new>
 
 namespace vkmini {
+
+void XcbEventHandler::handle(const xcb_generic_event_t* ev)
+{
+    const uint8_t type = ev->response_type & ~0x80;
+    switch(type)
+    {
+    case XCB_DESTROY_NOTIFY: alive_ = false; break;
+    case XCB_CONFIGURE_NOTIFY:
+    {
+        auto* c = (const xcb_configure_notify_event_t*)ev;
+        resize_.configure(FramebufferSize{ c->width, c->height });
+    } break;
+    case XCB_KEY_PRESS:
+        alive_ = false;
+        break;
+    default: break;
+    }
+}
+
 namespace {
 
 class XcbWindow final : public IPlatformWindow {
 public:
     explicit XcbWindow(const WindowCreateInfo& ci)
+        : events_(FramebufferSize{ ci.width, ci.height }, std::chrono::milliseconds(ci.resizeDebounceMs))
     {
         conn_ = xcb_connect(nullptr, nullptr);
         if (int err = xcb_connection_has_error(conn_); err) { ok_ = false; return; }
@@ -46,8 +69,6 @@ public:
 
         xcb_map_window(conn_, window_);
         xcb_flush(conn_);
-
-        fbw_ = ci.width; fbh_ = ci.height;
     }
 
     ~XcbWindow() override
@@ -60,7 +81,7 @@ public:
     }
 
     NativeWindow native() const override { return NativeWindow{ (void*)conn_, window_ }; }
-    FramebufferSize framebuffer_size() const override { return FramebufferSize{ fbw_, fbh_ }; }
+    FramebufferSize framebuffer_size() const override { return events_.resize().size(); }
 
     bool pump_events() override
     {
@@ -68,50 +89,56 @@ public:
         {
             xcb_generic_event_t* ev = xcb_poll_for_event(conn_);
             if (!ev) break;
-            handle(ev);
+            events_.handle(ev);
             std::free(ev);
         }
-        return alive_ && ok_;
+        events_.end_pump(ResizeCoalescer::Clock::now());
+        return events_.alive() && ok_;
     }
 
-    void wait_events() override
+    void wait_events(std::chrono::milliseconds timeout) override
     {
-        xcb_generic_event_t* ev = xcb_wait_for_event(conn_);
-        if (!ev) return;
-        handle(ev);
-        std::free(ev);
-    }
-
-    bool is_minimized() const override { return minimized_ || fbw_ == 0 || fbh_ == 0; }
-    const char* platform_name() const override { return "xcb"; }
-
-private:
-    void handle(xcb_generic_event_t* ev)
-    {
-        const uint8_t type = ev->response_type & ~0x80;
-        switch(type)
+        xcb_generic_event_t* ev = nullptr;
+        if (timeout == kNoTimeout) ev = xcb_wait_for_event(conn_);
+        else if (!(ev = xcb_poll_for_event(conn_)))
         {
-        case XCB_DESTROY_NOTIFY: alive_ = false; break;
-        case XCB_CONFIGURE_NOTIFY:
+            // XCB has no timed wait: wait for the connection's socket, then read what arrived.
+            xcb_flush(conn_);
+            pollfd pfd{ xcb_get_file_descriptor(conn_), POLLIN, 0 };
+            const int ms = int(std::min<std::chrono::milliseconds::rep>(timeout.count(), std::numeric_limits<int>::max()));
+            if (::poll(&pfd, 1, ms) > 0) ev = xcb_poll_for_event(conn_);
+        }
+        if (ev)
         {
-            auto* c = (xcb_configure_notify_event_t*)ev;
-            fbw_ = c->width;
-            fbh_ = c->height;
-            minimized_ = (fbw_ == 0 || fbh_ == 0);
-        } break;
-        case XCB_KEY_PRESS:
-            alive_ = false;
-            break;
-        default: break;
+            events_.handle(ev);
+            std::free(ev);
         }
+        else if (xcb_connection_has_error(conn_)) ok_ = false;
+        events_.end_pump(ResizeCoalescer::Clock::now());
+    }
+
+    // libxcb is thread-safe. A client message to our own window, sent with no event mask so the
+    // server delivers it to the window's creator, ends xcb_wait_for_event; the handler ignores it.
+    void wake() override
+    {
+        xcb_client_message_event_t msg{};
+        msg.response_type = XCB_CLIENT_MESSAGE;
+        msg.format = 32;
+        msg.window = window_;
+        msg.type = XCB_ATOM_NONE;
+        xcb_send_event(conn_, 0, window_, XCB_EVENT_MASK_NO_EVENT, reinterpret_cast<const char*>(&msg));
+        xcb_flush(conn_);
     }
 
+    bool is_minimized() const override { return events_.resize().minimized(); }
+    bool resize_settled() const override { return events_.resize().settled(ResizeCoalescer::Clock::now()); }
+    const char* platform_name() const override { return "xcb"; }
+
+private:
     xcb_connection_t* conn_ = nullptr;
     xcb_screen_t* screen_ = nullptr;
     xcb_window_t window_ = 0;
-    uint32_t fbw_ = 0, fbh_ = 0;
-    bool minimized_ = false;
-    bool alive_ = true;
+    XcbEventHandler events_;
     bool ok_ = true;
 };
 
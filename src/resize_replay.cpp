@@ -0,0 +1,199 @@
+#include "platform.hpp"
+#include <iostream>
+
+#if defined(_WIN32) || defined(__ANDROID__)
+
+namespace vkmini {
+
+int run_resize_replay()
+{
+    std::cerr << "[vkmini] --resize-replay drives the XCB backend's event handling; not available on this platform\n";
+    return 2;
+}
+
+} // namespace vkmini
+
+#else
+
+#include "platform_xcb.hpp"
+#include "swapchain_rebuild.hpp"
+#include <cstdio>
+#include <vector>
+
+namespace vkmini {
+
+using namespace std::chrono_literals;
+
+static constexpr auto kPumpInterval = 16ms; // one pump per 60 Hz frame
+static constexpr auto kDebounce = 100ms;
+
+// One pump: the configure events the window system queued since the previous one.
+using Pump = std::vector<FramebufferSize>;
+
+// How the simulated swapchain answers a present at a size other than the window's.
+enum class Driver : uint8_t {
+    Stale,     // keeps presenting (suboptimal at most) until the settled rebuild
+    OutOfDate, // out-of-date, as drivers may report when XCB's currentExtent moves with the window
+};
+
+struct ReplayResult {
+    uint64_t events = 0, changes = 0;
+    uint32_t rebuilds = 0;       // full rebuilds
+    uint32_t resizes = 0;        // live-resize steps: swapchain only
+    uint32_t scaled = 0;         // frames presented as a scaled blit of the scene
+    uint32_t outOfDate = 0;      // presents that reported out-of-date
+    uint32_t skipped = 0;        // frames skipped waiting for an out-of-date rebuild
+    uint32_t minimizedPumps = 0;
+    FramebufferSize built{};     // size of the last rebuild or resize
+};
+
+// One frame per pump, driven like the run loop: each pump's configure events go through the XCB
+// backend's event handler, then the render thread's SwapchainRebuildPolicy decides whether the
+// frame rebuilds, resizes, renders or is skipped; nothing renders while minimized. The replay
+// continues with empty pumps for twice the debounce window so the last size settles.
+static ReplayResult replay(const std::vector<Pump>& pumps, FramebufferSize initial, std::chrono::milliseconds debounce,
+                           bool liveResize, Driver driver = Driver::Stale)
+{
+    XcbEventHandler xcb(initial, debounce);
+    SwapchainRebuildPolicy policy(debounce, liveResize);
+    ReplayResult r;
+    SwapchainRebuildPolicy::Swapchain sc{ initial };
+    auto now = ResizeCoalescer::Clock::time_point{} + 1h;
+    const size_t total = pumps.size() + size_t(2 * debounce / kPumpInterval) + 1;
+    for (size_t i=0;i<total;++i, now+=kPumpInterval)
+    {
+        if (i < pumps.size())
+            for (FramebufferSize e : pumps[i])
+            {
+                xcb_configure_notify_event_t c{};
+                c.response_type = XCB_CONFIGURE_NOTIFY;
+                c.width = uint16_t(e.w);
+                c.height = uint16_t(e.h);
+                xcb.handle(reinterpret_cast<const xcb_generic_event_t*>(&c));
+            }
+        xcb.end_pump(now);
+        const ResizeCoalescer& rc = xcb.resize();
+        if (rc.minimized()) { ++r.minimizedPumps; continue; }
+
+        switch (policy.decide(rc.size(), rc.settled(now), sc, now))
+        {
+        case SwapchainRebuildPolicy::Action::Rebuild:
+            ++r.rebuilds;
+            sc = SwapchainRebuildPolicy::Swapchain{ rc.size() };
+            policy.rebuilt(now);
+            break;
+        case SwapchainRebuildPolicy::Action::Resize:
+            ++r.resizes;
+            sc = SwapchainRebuildPolicy::Swapchain{ rc.size(), true };
+            policy.rebuilt(now);
+            break;
+        case SwapchainRebuildPolicy::Action::Wait:
+            ++r.skipped;
+            continue;
+        case SwapchainRebuildPolicy::Action::Render:
+            break;
+        }
+        if (sc.scaled) ++r.scaled;
+        if (driver == Driver::OutOfDate && !(rc.size() == sc.built))
+        {
+            ++r.outOfDate;
+            sc.outOfDate = true;
+        }
+    }
+    r.built = sc.built;
+    r.events = xcb.resize().events();
+    r.changes = xcb.resize().changes();
+    return r;
+}
+
+// A one-second drag at 60 Hz, five motion steps queued per frame, one pixel each.
+static std::vector<Pump> drag_storm(FramebufferSize from)
+{
+    std::vector<Pump> pumps;
+    for (uint32_t p=0;p<60;++p)
+    {
+        Pump pump;
+        for (uint32_t k=1;k<=5;++k) pump.push_back(FramebufferSize{ from.w + p * 5 + k, from.h + p * 5 + k });
+        pumps.push_back(pump);
+    }
+    return pumps;
+}
+
+int run_resize_replay()
+{
+    const FramebufferSize start{ 1280, 720 };
+    bool ok = true;
+    std::cout << "[vkmini] Resize replay: " << kPumpInterval.count() << " ms pumps, "
+              << kDebounce.count() << " ms debounce\n";
+    auto report = [&](const char* name, const ReplayResult& r, bool pass) {
+        char line[224];
+        std::snprintf(line, sizeof(line),
+            "  %-34s %4llu events  %3llu sizes  %2u rebuilds  %2u resizes  %2u scaled  %2u out-of-date  %2u skipped  %s\n",
+            name, (unsigned long long)r.events, (unsigned long long)r.changes, r.rebuilds, r.resizes, r.scaled,
+            r.outOfDate, r.skipped, pass ? "ok" : "FAILED");
+        std::cout << line;
+        ok = ok && pass;
+    };
+    const FramebufferSize dragEnd{ start.w + 300, start.h + 300 };
+
+    {
+        // Every pump applies one size: the swapchain follows it with the old-size scene scaled in,
+        // and the full rebuild happens once, at the final size.
+        const auto r = replay(drag_storm(start), start, kDebounce, true);
+        report("drag storm", r, r.events == 300 && r.changes == 60 && r.resizes == 60 && r.rebuilds == 1
+                                && r.scaled >= 60 && r.built == dragEnd);
+    }
+    {
+        // The swapchain always matches the window, so a strict driver has nothing to report.
+        const auto r = replay(drag_storm(start), start, kDebounce, true, Driver::OutOfDate);
+        report("drag storm, out-of-date", r, r.resizes == 60 && r.rebuilds == 1 && r.outOfDate == 0 && r.skipped == 0
+                                             && r.built == dragEnd);
+    }
+    {
+        // Without a debounce window every applied size is a full rebuild: the coalescing alone.
+        const auto r = replay(drag_storm(start), start, 0ms, true);
+        report("drag storm, no debounce", r, r.changes == 60 && r.rebuilds == 60 && r.resizes == 0);
+    }
+    {
+        // Without live resize the old swapchain keeps presenting until the settled rebuild.
+        const auto r = replay(drag_storm(start), start, kDebounce, false);
+        report("no live resize: drag storm", r, r.changes == 60 && r.rebuilds == 1 && r.resizes == 0 && r.scaled == 0
+                                                && r.built == dragEnd);
+    }
+    {
+        // Without live resize, a driver that reports out-of-date on every size mismatch: the old
+        // swapchain cannot present, so it is rebuilt early, but at most once per debounce window
+        // while the drag lasts (the frames in between are skipped), then once more at the end.
+        const auto r = replay(drag_storm(start), start, kDebounce, false, Driver::OutOfDate);
+        const uint32_t drag = uint32_t(60 * kPumpInterval / kDebounce) + 1;
+        report("no live resize: out-of-date", r, r.changes == 60 && r.rebuilds > 1 && r.rebuilds <= drag + 1
+                                                 && r.skipped > 0 && r.built == dragEnd);
+    }
+    {
+        // A single resize that goes out-of-date is rebuilt on the next frame, not after the debounce.
+        const auto r = replay({ Pump{ FramebufferSize{ 800, 600 } } }, start, kDebounce, false, Driver::OutOfDate);
+        report("no live resize: one out-of-date", r, r.rebuilds == 1 && r.outOfDate == 1 && r.skipped == 0
+                                                     && r.built == FramebufferSize{ 800, 600 });
+    }
+    {
+        // Moving the window sends configure events with an unchanged size.
+        const auto r = replay(std::vector<Pump>(30, Pump{ start, start }), start, kDebounce, true);
+        report("window moves", r, r.events == 60 && r.changes == 0 && r.rebuilds == 0 && r.resizes == 0);
+    }
+    {
+        // Minimize and restore at the same size: nothing to rebuild, and no frames while minimized.
+        std::vector<Pump> pumps = { Pump{ FramebufferSize{ 0, 0 } }, Pump{}, Pump{}, Pump{ start } };
+        const auto r = replay(pumps, start, kDebounce, true);
+        report("minimize, restore", r, r.changes == 2 && r.rebuilds == 0 && r.resizes == 0 && r.minimizedPumps == 3);
+    }
+    {
+        // A drag that ends where it started within one pump is not a resize.
+        const auto r = replay({ Pump{ FramebufferSize{ 1300, 740 }, start } }, start, kDebounce, true);
+        report("drag and return", r, r.changes == 0 && r.rebuilds == 0 && r.resizes == 0);
+    }
+    return ok ? 0 : 1;
+}
+
+} // namespace vkmini
+
+#endif
@@ -0,0 +1,39 @@
+#include "staging_ring.hpp"
+
+namespace vkmini {
+
+static uint64_t align_up(uint64_t v, uint64_t a)
+{
+    return (v + a - 1) / a * a;
+}
+
+std::optional<uint64_t> StagingRing::find(uint64_t bytes) const
+{
+    if (occupied_.empty()) return bytes <= capacity_ ? std::optional<uint64_t>(0) : std::nullopt;
+
+    const uint64_t tail = occupied_.front().begin;
+    const uint64_t head = align_up(occupied_.back().end, alignment_);
+    const bool wrapped = occupied_.back().begin < tail;
+
+    if (!wrapped)
+    {
+        if (head + bytes <= capacity_) return head;
+        if (bytes <= tail)             return 0;
+        return std::nullopt;
+    }
+    if (head + bytes <= tail) return head;
+    return std::nullopt;
+}
+
+void StagingRing::occupy(uint64_t offset, uint64_t bytes, uint64_t ticket)
+{
+    occupied_.push_back(Range{ ticket, offset, offset + bytes });
+}
+
+void StagingRing::release(uint64_t completedTicket)
+{
+    while (!occupied_.empty() && occupied_.front().ticket <= completedTicket)
+        occupied_.pop_front();
+}
+
+} // namespace vkmini
@@ -0,0 +1,55 @@
+#include "startup.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+
+namespace vkmini {
+
+// Dynamic initialization runs before main(), so this is as close to launch as portable code gets.
+static const StartupReport::Clock::time_point kProcessStart = StartupReport::Clock::now();
+
+StartupReport::Clock::time_point StartupReport::process_start()
+{
+    return kProcessStart;
+}
+
+void StartupReport::add(const char* name, Clock::time_point begin, Clock::time_point end)
+{
+    const bool main = std::this_thread::get_id() == main_;
+    std::lock_guard lock(m_);
+    entries_.push_back(Entry{ name, begin, end, main });
+}
+
+void StartupReport::first_frame(std::ostream& out)
+{
+    if (reported_) return;
+    reported_ = true;
+    const Clock::time_point now = Clock::now();
+    if (setupDone_ != Clock::time_point{}) add("first frame", setupDone_, now);
+
+    std::vector<Entry> entries;
+    {
+        std::lock_guard lock(m_);
+        entries = entries_;
+    }
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.begin < b.begin; });
+
+    const auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    double busy = 0;
+    for (const auto& e : entries) busy += ms(e.end - e.begin);
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "[vkmini] Time to first frame: %.1f ms (%.1f ms of phase time, %.2fx wall)\n",
+        ms(now - kProcessStart), busy, busy / std::max(ms(now - kProcessStart), 1e-3));
+    out << line;
+    std::snprintf(line, sizeof(line), "  %-24s %-6s %9s %9s %9s\n", "phase", "thread", "start ms", "end ms", "ms");
+    out << line;
+    for (const auto& e : entries)
+    {
+        std::snprintf(line, sizeof(line), "  %-24s %-6s %9.1f %9.1f %9.1f\n", e.name, e.main ? "main" : "job",
+            ms(e.begin - kProcessStart), ms(e.end - kProcessStart), ms(e.end - e.begin));
+        out << line;
+    }
+}
+
+} // namespace vkmini
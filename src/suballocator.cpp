@@ -0,0 +1,133 @@
+#include "suballocator.hpp"
+#include <iterator>
+
+namespace vkmini {
+
+static uint64_t align_up(uint64_t v, uint64_t a)
+{
+    return (v + a - 1) / a * a;
+}
+
+static bool same_page(uint64_t a, uint64_t b, uint64_t page)
+{
+    return a / page == b / page;
+}
+
+BlockSuballocator::BlockSuballocator(uint64_t size, uint64_t granularity)
+    : size_(size), granularity_(granularity ? granularity : 1)
+{
+    ranges_.emplace(0, Range{ size, true, ResourceKind::Linear });
+    add_free(0, size);
+}
+
+void BlockSuballocator::add_free(uint64_t offset, uint64_t size)
+{
+    freeBySize_.emplace(size, offset);
+}
+
+void BlockSuballocator::remove_free(uint64_t offset, uint64_t size)
+{
+    auto [first, last] = freeBySize_.equal_range(size);
+    for (auto it = first; it != last; ++it)
+        if (it->second == offset) { freeBySize_.erase(it); return; }
+}
+
+// Free ranges are always coalesced, so a range's neighbours are either used or absent.
+bool BlockSuballocator::conflicts_before(Map::const_iterator it, uint64_t offset, ResourceKind kind) const
+{
+    if (it == ranges_.begin()) return false;
+    const auto prev = std::prev(it);
+    if (prev->second.free || prev->second.kind == kind) return false;
+    return same_page(prev->first + prev->second.size - 1, offset, granularity_);
+}
+
+bool BlockSuballocator::conflicts_after(Map::const_iterator it, uint64_t end, ResourceKind kind) const
+{
+    const auto next = std::next(it);
+    if (next == ranges_.end() || next->second.free || next->second.kind == kind) return false;
+    return same_page(end - 1, next->first, granularity_);
+}
+
+std::optional<uint64_t> BlockSuballocator::allocate(uint64_t size, uint64_t alignment, ResourceKind kind)
+{
+    if (size == 0) return std::nullopt;
+    if (alignment == 0) alignment = 1;
+
+    // Smallest free range that still fits once alignment and granularity padding are applied.
+    for (auto fit = freeBySize_.lower_bound(size); fit != freeBySize_.end(); ++fit)
+    {
+        const auto it = ranges_.find(fit->second);
+        const uint64_t start = it->first;
+        const uint64_t rangeEnd = start + it->second.size;
+
+        uint64_t offset = align_up(start, alignment);
+        if (conflicts_before(it, offset, kind))
+            offset = align_up(offset, granularity_);
+
+        const uint64_t end = offset + size;
+        if (end > rangeEnd || conflicts_after(it, end, kind)) continue;
+
+        freeBySize_.erase(fit);
+        ranges_.erase(it);
+        if (offset > start)
+        {
+            ranges_.emplace(start, Range{ offset - start, true, ResourceKind::Linear });
+            add_free(start, offset - start);
+        }
+        ranges_.emplace(offset, Range{ size, false, kind });
+        if (rangeEnd > end)
+        {
+            ranges_.emplace(end, Range{ rangeEnd - end, true, ResourceKind::Linear });
+            add_free(end, rangeEnd - end);
+        }
+
+        used_ += size;
+        ++allocations_;
+        return offset;
+    }
+    return std::nullopt;
+}
+
+bool BlockSuballocator::free(uint64_t offset) noexcept
+{
+    auto it = ranges_.find(offset);
+    if (it == ranges_.end() || it->second.free) return false;
+
+    used_ -= it->second.size;
+    --allocations_;
+    it->second.free = true;
+
+    const auto next = std::next(it);
+    if (next != ranges_.end() && next->second.free)
+    {
+        remove_free(next->first, next->second.size);
+        it->second.size += next->second.size;
+        ranges_.erase(next);
+    }
+    if (it != ranges_.begin())
+    {
+        const auto prev = std::prev(it);
+        if (prev->second.free)
+        {
+            remove_free(prev->first, prev->second.size);
+            prev->second.size += it->second.size;
+            ranges_.erase(it);
+            it = prev;
+        }
+    }
+    add_free(it->first, it->second.size);
+    return true;
+}
+
+BlockStats BlockSuballocator::stats() const
+{
+    BlockStats st{};
+    st.size = size_;
+    st.used = used_;
+    st.allocations = allocations_;
+    st.freeRanges = (uint32_t)freeBySize_.size();
+    if (!freeBySize_.empty()) st.largestFree = std::prev(freeBySize_.end())->first;
+    return st;
+}
+
+} // namespace vkmini
@@ -0,0 +1,291 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace vkmini::trace {
+
+namespace {
+
+enum class Kind : uint32_t { Zone, Counter };
+
+struct Event {
+    const char* name;
+    uint64_t ts;     // steady_clock ns
+    uint64_t value;  // zone duration in ns, or the counter value
+    Kind kind;
+};
+
+// 16K events (512 KB) per thread; the drain thread empties it every few milliseconds.
+static constexpr uint32_t kRingSize = 1u << 14;
+static constexpr auto kDrainInterval = std::chrono::milliseconds(5);
+
+} // namespace
+
+// Single-producer/single-consumer ring: the owning thread pushes, the drain thread pops.
+// Both counters only ever grow; their difference is the fill level.
+class Track {
+public:
+    Track(uint32_t id, std::string name) : id(id), name(std::move(name)), ring_(std::make_unique<Event[]>(kRingSize)) {}
+
+    void push(const Event& e)
+    {
+        const uint32_t h = head_.load(std::memory_order_relaxed);
+        if (h - tail_.load(std::memory_order_acquire) == kRingSize)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ring_[h & (kRingSize - 1)] = e;
+        head_.store(h + 1, std::memory_order_release);
+    }
+
+    void drain()
+    {
+        if (!ring_) return;
+        uint32_t t = tail_.load(std::memory_order_relaxed);
+        const uint32_t h = head_.load(std::memory_order_acquire);
+        for (; t != h; ++t) events.push_back(ring_[t & (kRingSize - 1)]);
+        tail_.store(t, std::memory_order_release);
+    }
+
+    // The owning thread has exited: keep what it recorded, free the ring.
+    void retire()
+    {
+        drain();
+        ring_.reset();
+        retired = true;
+    }
+
+    const uint32_t id;
+    std::string name;              // guarded by the registry mutex
+    std::vector<Event> events;     // drained events, owned by the drain side
+    std::atomic<uint64_t> dropped{ 0 };
+    bool retired = false;          // guarded by the registry mutex
+
+private:
+    alignas(64) std::atomic<uint32_t> head_{ 0 };
+    alignas(64) std::atomic<uint32_t> tail_{ 0 };
+    std::unique_ptr<Event[]> ring_;
+};
+
+namespace {
+
+struct Registry {
+    std::mutex mutex;
+    // A thread's track goes when the thread exits, or once the trace is written if it exits while
+    // a session records; non-thread tracks stay.
+    std::vector<std::unique_ptr<Track>> tracks;
+    uint32_t nextId = 1;
+    bool recording = false; // from Session start until its trace is written
+    std::atomic<bool> active{ false };
+
+    std::thread drainer;
+    std::condition_variable cv;
+    bool stop = false;
+
+    Track* add(std::string name)
+    {
+        std::lock_guard lock(mutex);
+        const uint32_t id = nextId++;
+        if (name.empty()) name = "thread " + std::to_string(id);
+        tracks.push_back(std::make_unique<Track>(id, std::move(name)));
+        return tracks.back().get();
+    }
+
+    void retire(Track* t)
+    {
+        std::lock_guard lock(mutex);
+        if (recording) t->retire();
+        else std::erase_if(tracks, [t](const auto& p) { return p.get() == t; });
+    }
+
+    void drain_all()
+    {
+        std::lock_guard lock(mutex);
+        for (auto& t : tracks) t->drain();
+    }
+};
+
+Registry& registry()
+{
+    static Registry r;
+    return r;
+}
+
+// The calling thread's track, handed back to the registry when the thread exits.
+struct ThreadTrack {
+    Track* track = nullptr;
+    ~ThreadTrack() { if (track) registry().retire(track); }
+};
+
+thread_local const char* threadName = nullptr;
+thread_local ThreadTrack threadTrack;
+
+// Created on the thread's first event, so only threads that record while a session is open get a ring.
+Track* this_thread_track()
+{
+    if (!threadTrack.track) threadTrack.track = registry().add(threadName ? threadName : "");
+    return threadTrack.track;
+}
+
+// JSON string contents: quotes, backslashes and control characters escaped.
+void write_escaped(std::ostream& out, std::string_view s)
+{
+    for (const char c : s)
+    {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if ((unsigned char)c < 0x20)
+        {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)(unsigned char)c);
+            out << buf;
+        }
+        else out << c;
+    }
+}
+
+void write_json(const std::string& path)
+{
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+
+    uint64_t origin = ~0ull;
+    size_t count = 0;
+    uint64_t dropped = 0;
+    for (const auto& t : r.tracks)
+    {
+        for (const Event& e : t->events) origin = std::min(origin, e.ts);
+        count += t->events.size();
+        dropped += t->dropped.load(std::memory_order_relaxed);
+    }
+    if (origin == ~0ull) origin = 0;
+
+    std::ofstream out(path, std::ios::binary);
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << dropped << "},\"traceEvents\":[\n"
+        << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"vkmini\"}}";
+    for (const auto& t : r.tracks)
+    {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t->id
+            << ",\"args\":{\"name\":\"";
+        write_escaped(out, t->name);
+        out << "\"}}";
+        for (const Event& e : t->events)
+        {
+            const double ts = double(e.ts - origin) / 1000.0;
+            out << ",\n{\"name\":\"";
+            write_escaped(out, e.name);
+            if (e.kind == Kind::Zone)
+                out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << t->id
+                    << ",\"ts\":" << ts << ",\"dur\":" << double(e.value) / 1000.0 << "}";
+            else
+                out << "\",\"ph\":\"C\",\"pid\":1,\"ts\":" << ts
+                    << ",\"args\":{\"value\":" << (int64_t)e.value << "}}";
+        }
+    }
+    out << "\n]}\n";
+
+    if (!out)
+    {
+        std::cerr << "[vkmini] Trace: cannot write " << path << "\n";
+        return;
+    }
+    std::cout << "[vkmini] Trace written to " << path << " (" << count << " events";
+    if (dropped) std::cout << ", " << dropped << " dropped";
+    std::cout << ")\n";
+}
+
+} // namespace
+
+bool active()
+{
+    return registry().active.load(std::memory_order_relaxed);
+}
+
+void set_thread_name(const char* name)
+{
+    threadName = name;
+    if (!threadTrack.track) return; // named when its track is created
+    std::lock_guard lock(registry().mutex);
+    threadTrack.track->name = name;
+}
+
+Track* track(const char* name)
+{
+    return registry().add(name);
+}
+
+void zone(Track* t, const char* name, uint64_t beginNs, uint64_t endNs)
+{
+    if (!active()) return;
+    t->push(Event{ name, beginNs, endNs > beginNs ? endNs - beginNs : 0, Kind::Zone });
+}
+
+void emit_zone(const char* name, uint64_t beginNs, uint64_t endNs)
+{
+    this_thread_track()->push(Event{ name, beginNs, endNs - beginNs, Kind::Zone });
+}
+
+void counter(const char* name, int64_t value)
+{
+    if (!active()) return;
+    this_thread_track()->push(Event{ name, now_ns(), (uint64_t)value, Kind::Counter });
+}
+
+Session::Session(std::string path) : path_(std::move(path))
+{
+    if (path_.empty()) return;
+    Registry& r = registry();
+    {
+        std::lock_guard lock(r.mutex);
+        for (auto& t : r.tracks)
+        {
+            t->drain();
+            t->events.clear();
+            t->dropped.store(0, std::memory_order_relaxed);
+        }
+        r.stop = false;
+        r.recording = true;
+    }
+    r.drainer = std::thread([&r] {
+        std::unique_lock lock(r.mutex);
+        while (!r.stop)
+        {
+            r.cv.wait_for(lock, kDrainInterval, [&] { return r.stop; });
+            for (auto& t : r.tracks) t->drain();
+        }
+    });
+    r.active.store(true, std::memory_order_relaxed);
+}
+
+Session::~Session()
+{
+    if (path_.empty()) return;
+    Registry& r = registry();
+    r.active.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(r.mutex);
+        r.stop = true;
+    }
+    r.cv.notify_one();
+    r.drainer.join();
+    r.drain_all(); // zones that were open when recording stopped
+    write_json(path_);
+
+    std::lock_guard lock(r.mutex);
+    r.recording = false;
+    std::erase_if(r.tracks, [](const auto& t) { return t->retired; });
+}
+
+} // namespace vkmini::trace
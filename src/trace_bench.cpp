@@ -0,0 +1,130 @@
+#include "trace.hpp"
+#include "microbench.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace vkmini {
+
+// Zones per burst while measuring: well under a ring (16K events), with a pause long enough for
+// the drain thread to empty it, so the ring wraps many times without dropping.
+static constexpr uint32_t kBurst = 2048;
+static constexpr auto kBurstPause = std::chrono::milliseconds(10);
+// Pushed back to back, far more than a ring holds before the drain thread gets to it.
+static constexpr uint32_t kFlood = 1u << 18;
+
+static std::string read_file(const std::filesystem::path& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+}
+
+static size_t count(std::string_view text, std::string_view what)
+{
+    size_t n = 0;
+    for (size_t p = text.find(what); p != std::string_view::npos; p = text.find(what, p + what.size())) ++n;
+    return n;
+}
+
+static uint64_t dropped_events(const std::string& json)
+{
+    constexpr std::string_view key = "\"droppedEvents\":";
+    const size_t p = json.find(key);
+    return p == std::string::npos ? ~0ull : std::strtoull(json.c_str() + p + key.size(), nullptr, 10);
+}
+
+// Each check returns an error message, or null when the trace behaved.
+static const char* check_wrap(uint32_t zones, const std::filesystem::path& path, double& nsPerZone)
+{
+    uint64_t busyNs = 0;
+    {
+        trace::Session session(path.string());
+        for (uint32_t done=0;done<zones;)
+        {
+            const uint32_t burst = std::min(kBurst, zones - done);
+            const uint64_t t0 = trace::now_ns();
+            for (uint32_t i=0;i<burst;++i) trace::Zone z("wrap");
+            busyNs += trace::now_ns() - t0;
+            done += burst;
+            std::this_thread::sleep_for(kBurstPause);
+        }
+    }
+    nsPerZone = double(busyNs) / zones;
+
+    const std::string json = read_file(path);
+    if (dropped_events(json) != 0) return "wrap: events dropped although the ring was drained between bursts";
+    if (count(json, "{\"name\":\"wrap\",\"ph\":\"X\"") != zones) return "wrap: zones lost or duplicated across ring wraps";
+    return nullptr;
+}
+
+static const char* check_full_ring(const std::filesystem::path& path)
+{
+    {
+        trace::Session session(path.string());
+        for (uint32_t i=0;i<kFlood;++i) trace::Zone z("flood");
+    }
+    const std::string json = read_file(path);
+    const uint64_t dropped = dropped_events(json), kept = count(json, "{\"name\":\"flood\",\"ph\":\"X\"");
+    if (!dropped || dropped == ~0ull) return "full ring: no drops counted";
+    if (kept + dropped != kFlood) return "full ring: recorded plus dropped events do not add up";
+    return nullptr;
+}
+
+static const char* check_escaping(const std::filesystem::path& path)
+{
+    {
+        trace::Session session(path.string());
+        std::thread([] {
+            trace::set_thread_name("worker \"7\"");
+            { trace::Zone z("quote\"d"); }
+            { trace::Zone z("back\\slash"); }
+            { trace::Zone z("new\nline\ttab"); }
+        }).join();
+    }
+    const std::string json = read_file(path);
+    for (const char* escaped : { R"("name":"worker \"7\"")", R"("name":"quote\"d")", R"("name":"back\\slash")",
+                                 R"("name":"new\u000aline\u0009tab")" })
+        if (count(json, escaped) != 1) return "escaping: a name is missing or not escaped";
+    if (json.find("new\nline") != std::string::npos || json.find("back\\slash\"") != std::string::npos)
+        return "escaping: a raw name was written";
+    return nullptr;
+}
+
+int run_trace_bench(uint32_t zones)
+{
+    std::cout << "[vkmini] Trace bench: " << zones << " zones per run\n";
+    const auto path = std::filesystem::temp_directory_path() /
+        ("vkmini_trace_bench_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".json");
+
+    // No session open: the cost every instrumented scope pays in a normal run.
+    const BenchTiming idle = time_runs([&] {
+        for (uint32_t i=0;i<zones;++i) trace::Zone z("idle");
+    });
+
+    double recordingNs = 0;
+    bool ok = true;
+    for (const char* error : { check_wrap(zones, path, recordingNs), check_full_ring(path), check_escaping(path) })
+    {
+        if (!error) continue;
+        std::cerr << "[vkmini] Trace bench: " << error << "\n";
+        ok = false;
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "  idle       %8.2f ns/zone\n  recording  %8.2f ns/zone\n",
+        idle.medianMs * 1e6 / zones, recordingNs);
+    std::cout << line;
+    return ok ? 0 : 1;
+}
+
+} // namespace vkmini
@@ -0,0 +1,177 @@
+#include "vk_allocator.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace vkmini {
+
+Allocation& Allocation::operator=(Allocation&& o) noexcept
+{
+    if (this != &o)
+    {
+        reset();
+        owner_   = std::exchange(o.owner_, nullptr);
+        memType_ = o.memType_;
+        block_   = o.block_;
+        mem_     = std::exchange(o.mem_, vk::DeviceMemory{});
+        offset_  = std::exchange(o.offset_, 0);
+        size_    = std::exchange(o.size_, 0);
+        mapped_  = std::exchange(o.mapped_, nullptr);
+    }
+    return *this;
+}
+
+void Allocation::reset() noexcept
+{
+    if (owner_) owner_->free(memType_, block_, offset_);
+    owner_ = nullptr;
+    mem_ = vk::DeviceMemory{};
+    offset_ = size_ = 0;
+    mapped_ = nullptr;
+}
+
+void DeviceAllocator::init(vk::PhysicalDevice pd, vk::Device dev, vk::DeviceSize blockSize)
+{
+    const auto limits = pd.getProperties().limits;
+    dev_ = dev;
+    memProps_ = pd.getMemoryProperties();
+    granularity_ = limits.bufferImageGranularity;
+    maxAllocations_ = limits.maxMemoryAllocationCount;
+    blockSize_ = blockSize;
+}
+
+uint32_t DeviceAllocator::find_mem_type(uint32_t typeBits, vk::MemoryPropertyFlags props) const
+{
+    for (uint32_t i=0;i<memProps_.memoryTypeCount;++i)
+        if ((typeBits & (1u<<i)) && ((memProps_.memoryTypes[i].propertyFlags & props) == props))
+            return i;
+    throw std::runtime_error("No suitable memory type");
+}
+
+uint32_t DeviceAllocator::add_block(uint32_t memType, vk::DeviceSize size, bool dedicated)
+{
+    if (liveAllocations_ >= maxAllocations_)
+        throw std::runtime_error("maxMemoryAllocationCount reached");
+
+    auto mem = dev_.allocateMemoryUnique(vk::MemoryAllocateInfo{ size, memType });
+    std::byte* mapped = nullptr;
+    if (memProps_.memoryTypes[memType].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible)
+        mapped = static_cast<std::byte*>(dev_.mapMemory(mem.get(), 0, VK_WHOLE_SIZE));
+
+    auto block = std::unique_ptr<Block>(new Block{
+        std::move(mem), BlockSuballocator(size, dedicated ? 1 : granularity_), mapped, dedicated });
+    ++liveAllocations_;
+
+    auto& list = blocks_[memType];
+    for (uint32_t i=0;i<(uint32_t)list.size();++i)
+        if (!list[i]) { list[i] = std::move(block); return i; }
+    list.push_back(std::move(block));
+    return (uint32_t)list.size() - 1;
+}
+
+Allocation DeviceAllocator::allocate(const vk::MemoryRequirements& req, vk::MemoryPropertyFlags props, ResourceKind kind)
+{
+    const uint32_t type = find_mem_type(req.memoryTypeBits, props);
+    const vk::DeviceSize heapSize = memProps_.memoryHeaps[memProps_.memoryTypes[type].heapIndex].size;
+    // Small heaps (e.g. the 256 MiB BAR window) get proportionally smaller blocks.
+    const vk::DeviceSize blockSize = std::max<vk::DeviceSize>(std::min(blockSize_, heapSize / 8), 1024 * 1024);
+
+    std::lock_guard lock(mutex_);
+    auto& list = blocks_[type];
+
+    auto make = [&](uint32_t idx, vk::DeviceSize offset) {
+        Block& b = *list[idx];
+        return Allocation{ this, type, idx, b.mem.get(), offset, req.size, b.mapped ? b.mapped + offset : nullptr };
+    };
+
+    if (req.size > blockSize / 2)
+    {
+        const uint32_t idx = add_block(type, req.size, true);
+        return make(idx, *list[idx]->policy.allocate(req.size, req.alignment, kind));
+    }
+
+    for (uint32_t i=0;i<(uint32_t)list.size();++i)
+    {
+        if (!list[i] || list[i]->dedicated) continue;
+        if (auto off = list[i]->policy.allocate(req.size, req.alignment, kind))
+            return make(i, *off);
+    }
+
+    const uint32_t idx = add_block(type, blockSize, false);
+    auto off = list[idx]->policy.allocate(req.size, req.alignment, kind);
+    if (!off) throw std::runtime_error("DeviceAllocator: allocation does not fit a fresh block");
+    return make(idx, *off);
+}
+
+void DeviceAllocator::free(uint32_t memType, uint32_t block, vk::DeviceSize offset) noexcept
+{
+    std::lock_guard lock(mutex_);
+    auto& list = blocks_[memType];
+    if (block >= list.size() || !list[block] || !list[block]->policy.free(offset))
+    {
+        std::cerr << "[vkmini] DeviceAllocator: ignoring free of unknown range (memory type " << memType
+                  << ", block " << block << ", offset " << offset << ")\n";
+        return;
+    }
+    Block& b = *list[block];
+    if (!b.policy.empty()) return;
+
+    // Keep one empty shared block per memory type around to avoid allocate/free churn.
+    bool spare = b.dedicated;
+    for (uint32_t i=0;i<(uint32_t)list.size() && !spare;++i)
+        spare = i != block && list[i] && !list[i]->dedicated && list[i]->policy.empty();
+    if (spare)
+    {
+        list[block].reset();
+        --liveAllocations_;
+    }
+}
+
+std::vector<HeapStats> DeviceAllocator::stats() const
+{
+    std::lock_guard lock(mutex_);
+    std::vector<HeapStats> heaps(memProps_.memoryHeapCount);
+    std::vector<vk::DeviceSize> freeBytes(memProps_.memoryHeapCount, 0);
+
+    for (uint32_t t=0;t<memProps_.memoryTypeCount;++t)
+    {
+        const uint32_t heap = memProps_.memoryTypes[t].heapIndex;
+        for (const auto& b : blocks_[t])
+        {
+            if (!b) continue;
+            const BlockStats st = b->policy.stats();
+            HeapStats& h = heaps[heap];
+            h.blocks++;
+            h.allocations += st.allocations;
+            h.reserved += st.size;
+            h.used += st.used;
+            h.largestFree = std::max<vk::DeviceSize>(h.largestFree, st.largestFree);
+            freeBytes[heap] += st.size - st.used;
+        }
+    }
+
+    for (uint32_t h=0;h<memProps_.memoryHeapCount;++h)
+        if (freeBytes[h])
+            heaps[h].fragmentation = 1.0f - float(double(heaps[h].largestFree) / double(freeBytes[h]));
+    return heaps;
+}
+
+std::string DeviceAllocator::format_stats() const
+{
+    constexpr double MiB = 1024.0 * 1024.0;
+    const auto heaps = stats();
+    std::ostringstream os;
+    for (uint32_t h=0;h<(uint32_t)heaps.size();++h)
+    {
+        const HeapStats& st = heaps[h];
+        if (!st.blocks) continue;
+        os << "[Vulkan] heap " << h << ": " << st.blocks << " blocks, " << st.allocations << " allocations, "
+           << st.used / MiB << " / " << st.reserved / MiB << " MiB used, largest free "
+           << st.largestFree / MiB << " MiB, fragmentation " << st.fragmentation * 100.0f << "%\n";
+    }
+    return os.str();
+}
+
+} // namespace vkmini
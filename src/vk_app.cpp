@@ -1,14 +1,71 @@
 #include "vk_app.hpp"
 #include "vk_state.hpp"
 #include "vk_internal.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
 
 namespace vkmini {
 
-void VkApp::run(IPlatformWindow& window)
+static void start_bench(AppState& s)
+{
+    // Skip driver/pipeline warm-up: up to 10 frames, never more than a tenth of the run.
+    if (s.opts.bench)
+        s.bench.start(s.opts.frames, std::min(10u, s.opts.frames / 10));
+}
+
+// Writes the --bench report and runs the baseline comparison. Returns the process exit code.
+static int finish_bench(AppState& s)
+{
+    if (!s.bench.active()) return 0;
+
+    BenchInfo info{};
+    info.device = s.pd.getProperties().deviceName.data();
+    info.mode = s.opts.headless ? "headless" : "windowed";
+    info.width = s.sc.extent.width;
+    info.height = s.sc.extent.height;
+    const std::string json = s.bench.to_json(info);
+
+    if (s.opts.benchOut.empty()) std::cout << json;
+    else
+    {
+        std::ofstream out(s.opts.benchOut, std::ios::binary);
+        out << json;
+        if (!out) throw std::runtime_error("bench: cannot write " + s.opts.benchOut);
+        std::cout << "[bench] Report written to " << s.opts.benchOut << "\n";
+    }
+
+    if (!s.opts.benchCompare.empty() && !s.bench.compare(s.opts.benchCompare, s.opts.benchThreshold, std::cout))
+        return 3;
+    return 0;
+}
+
+int VkApp::run(IPlatformWindow& window, const AppOptions& opts)
 {
+    // Declared first so it outlives the state and sees every zone close.
+    trace::Session trace(opts.trace);
+    VKMINI_TRACE_THREAD_NAME("render");
     AppState s{};
-    setup(s, window);
+    s.opts = opts;
+    setup(s, &window);
+    start_bench(s);
     run_loop(s, window);
+    return finish_bench(s);
+}
+
+int VkApp::run_headless(const AppOptions& opts)
+{
+    trace::Session trace(opts.trace);
+    VKMINI_TRACE_THREAD_NAME("render");
+    AppState s{};
+    s.opts = opts;
+    setup(s, nullptr);
+    start_bench(s);
+    vkmini::run_headless(s);
+    return finish_bench(s);
 }
 
 } // namespace vkmini
@@ -0,0 +1,187 @@
+#include "vk_state.hpp"
+#include "vk_internal.hpp"
+#include "vk_helpers.hpp"
+#include "vk_check.hpp"
+#include "vk_validation.hpp"
+#include "trace.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace vkmini {
+
+// Offscreen color format: universally supported as a color attachment and copy source,
+// and its bytes map straight onto PPM's RGB triples.
+static constexpr vk::Format kOffscreenFormat = vk::Format::eR8G8B8A8Unorm;
+
+void create_offscreen_targets(AppState& s)
+{
+    s.sc.surfFmt = vk::SurfaceFormatKHR{ kOffscreenFormat, vk::ColorSpaceKHR::eSrgbNonlinear };
+    s.sc.extent = vk::Extent2D{ s.opts.width, s.opts.height };
+    s.sc.finalLayout = vk::ImageLayout::eTransferSrcOptimal;
+
+    // One target per frame in flight: retiring a frame slot also frees its image, which is what
+    // the per-image timeline values track for a swapchain.
+    s.sc.offscreen.clear();
+    s.sc.images.clear();
+    s.sc.views.clear();
+    for (uint32_t i=0;i<s.sync.framesInFlight;++i)
+    {
+        Image img = create_image(s.alloc, s.sc.extent.width, s.sc.extent.height, kOffscreenFormat,
+            vk::ImageTiling::eOptimal,
+            vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+            vk::MemoryPropertyFlagBits::eDeviceLocal);
+        s.sc.images.push_back(img.img.get());
+        s.sc.views.push_back(s.device->createImageViewUnique(vk::ImageViewCreateInfo{
+            {}, img.img.get(), vk::ImageViewType::e2D, kOffscreenFormat,
+            {}, vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0,1,0,1 }
+        }));
+        s.sc.offscreen.push_back(std::move(img));
+    }
+}
+
+// Copies target imageIndex (in TransferSrcOptimal, idle) to host memory and writes it as binary PPM.
+static void write_readback(AppState& s, uint32_t imageIndex, const std::string& path)
+{
+    const uint32_t w = s.sc.extent.width, h = s.sc.extent.height;
+    const vk::DeviceSize bytes = vk::DeviceSize(w) * h * 4;
+
+    Buffer dst = create_buffer(s.alloc, bytes, vk::BufferUsageFlagBits::eTransferDst,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+    auto cb = std::move(s.device->allocateCommandBuffersUnique(vk::CommandBufferAllocateInfo{
+        s.cmdPool.get(), vk::CommandBufferLevel::ePrimary, 1 })[0]);
+    cb->begin(vk::CommandBufferBeginInfo{ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+
+    vk::BufferImageCopy region{};
+    region.imageSubresource = vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, 0,0,1 };
+    region.imageExtent = vk::Extent3D{ w,h,1 };
+    cb->copyImageToBuffer(s.sc.images[imageIndex], vk::ImageLayout::eTransferSrcOptimal, dst.buf.get(), 1, &region);
+
+    const vk::MemoryBarrier toHost{ vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead };
+    cb->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, 1,&toHost, 0,nullptr, 0,nullptr);
+    cb->end();
+
+    auto fence = s.device->createFenceUnique(vk::FenceCreateInfo{});
+    vk::CommandBuffer cbh = cb.get();
+    {
+        auto qlock = s.streaming.lock_shared_queue();
+        s.graphicsQueue.submit(vk::SubmitInfo{ 0,nullptr,nullptr, 1,&cbh }, fence.get());
+    }
+    VK_CHECK(s.device->waitForFences(fence.get(), true, std::numeric_limits<uint64_t>::max()));
+
+    std::ofstream out(path, std::ios::binary);
+    out << "P6\n" << w << " " << h << "\n255\n";
+    const auto* px = static_cast<const uint8_t*>(dst.mem.mapped());
+    std::vector<char> row(size_t(w) * 3);
+    for (uint32_t y=0;y<h;++y)
+    {
+        for (uint32_t x=0;x<w;++x)
+            for (uint32_t c=0;c<3;++c)
+                row[size_t(x)*3 + c] = (char)px[(size_t(y)*w + x)*4 + c];
+        out.write(row.data(), (std::streamsize)row.size());
+    }
+    if (!out) throw std::runtime_error("readback: cannot write " + path);
+    std::cout << "[vkmini] Wrote " << w << "x" << h << " frame to " << path << "\n";
+}
+
+void run_headless(AppState& s)
+{
+    DebugMessenger dbg = create_debug_messenger(s.instance.get());
+
+    const auto t0 = std::chrono::steady_clock::now();
+    uint32_t last = 0;
+
+    for (uint32_t n=0;n<s.opts.frames;++n)
+    {
+        VKMINI_TRACE_ZONE("frame");
+        s.bench.begin_frame();
+        const uint32_t frame = s.sync.pacer.frame();
+
+        {
+            BenchScope t(s.bench, BenchPhase::Wait);
+            VKMINI_TRACE_ZONE("wait");
+            s.sync.pacer.begin_frame();
+        }
+        s.streaming.begin_frame(frame);
+
+        const uint32_t imageIndex = frame;
+        auto& cb = s.cmdBuffers[imageIndex];
+        std::vector<vk::Semaphore> waitSems;
+        std::vector<vk::PipelineStageFlags> waitStages;
+        {
+            BenchScope t(s.bench, BenchPhase::Record);
+            VKMINI_TRACE_ZONE("record");
+            // Fixed timestep, so a given frame count always produces the same image.
+            const FrameOffsets offsets = update_uniforms(s, frame, float(n) * kBenchTimestep);
+
+            cb->reset();
+            cb->begin(vk::CommandBufferBeginInfo{});
+            s.gpu.begin_frame(frame, cb.get());
+            const uint32_t acquireZone = s.gpu.begin_zone(cb.get(), "transfer acquire");
+            s.streaming.acquire(frame, cb.get(), waitSems, waitStages);
+            s.gpu.end_zone(cb.get(), acquireZone);
+            stream_texture(s);
+            record_scene(s, cb.get(), frame, imageIndex, offsets);
+            cb->end();
+        }
+
+        // The transfer handoffs are binary semaphores (their wait values are ignored); the frame
+        // signals its value on the timeline.
+        vk::CommandBuffer cbh = cb.get();
+        const vk::Semaphore timeline = s.sync.pacer.timeline();
+        const uint64_t value = s.sync.pacer.frame_value();
+        const std::vector<uint64_t> waitValues(waitSems.size(), 0);
+        vk::TimelineSemaphoreSubmitInfo values{ (uint32_t)waitValues.size(), waitValues.data(), 1, &value };
+        vk::SubmitInfo submit{ (uint32_t)waitSems.size(), waitSems.data(), waitStages.data(), 1, &cbh, 1, &timeline };
+        submit.pNext = &values;
+        {
+            auto qlock = s.streaming.lock_shared_queue();
+            BenchScope t(s.bench, BenchPhase::Submit);
+            VKMINI_TRACE_ZONE("submit");
+            s.graphicsQueue.submit(submit, nullptr);
+        }
+        s.sync.pacer.end_frame();
+        // No present to stamp: the first frame counts once the GPU has finished it.
+        if (n == 0)
+        {
+            s.sync.pacer.wait(value);
+            s.startup.first_frame(std::cout);
+        }
+        s.bench.end_frame();
+
+        last = imageIndex;
+    }
+
+    s.streaming.stop();
+    s.device->waitIdle();
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[vkmini] Headless: " << s.opts.frames << " frames at " << s.sc.extent.width << "x" << s.sc.extent.height
+              << " in " << ms << " ms (" << (s.opts.frames ? ms / s.opts.frames : 0.0) << " ms/frame)\n";
+
+    if (!s.opts.readback.empty() && s.opts.frames)
+        write_readback(s, last, s.opts.readback);
+
+    s.gpu.finish();
+    std::cout << s.gpu.format_summary();
+    std::cout << s.sync.pacer.format_summary();
+    std::cout << format_debug_message_stats();
+    if (s.texStream.period)
+        std::cout << "[vkmini] Texture streaming: " << s.texStream.uploads << " uploads acquired (every "
+                  << s.texStream.period << " frames)\n";
+    std::cout << s.alloc.format_stats();
+    std::cout << s.pipelineCache.format_stats();
+    s.pipelineCache.save();
+
+    if (dbg.destroy && dbg.handle)
+        dbg.destroy(s.instance.get(), dbg.handle, nullptr);
+}
+
+} // namespace vkmini
@@ -4,66 +4,214 @@
 #include "vk_device_select.hpp"
 #include "vk_helpers.hpp"
 #include "vk_check.hpp"
+#include "vk_shaders.hpp"
+#include "math.hpp"
 #include "platform.hpp"
+#include "trace.hpp"
 
-#include <shaderc/shaderc.hpp>
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <set>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace vkmini {
 
-static constexpr std::array<Vertex, 36> kCube = {{
-    {-1,-1, 1, 0,1}, { 1,-1, 1, 1,1}, { 1, 1, 1, 1,0},
-    {-1,-1, 1, 0,1}, { 1, 1, 1, 1,0}, {-1, 1, 1, 0,0},
-    { 1,-1,-1, 0,1}, {-1,-1,-1, 1,1}, {-1, 1,-1, 1,0},
-    { 1,-1,-1, 0,1}, {-1, 1,-1, 1,0}, { 1, 1,-1, 0,0},
-    {-1,-1,-1, 0,1}, {-1,-1, 1, 1,1}, {-1, 1, 1, 1,0},
-    {-1,-1,-1, 0,1}, {-1, 1, 1, 1,0}, {-1, 1,-1, 0,0},
-    { 1,-1, 1, 0,1}, { 1,-1,-1, 1,1}, { 1, 1,-1, 1,0},
-    { 1,-1, 1, 0,1}, { 1, 1,-1, 1,0}, { 1, 1, 1, 0,0},
-    {-1, 1, 1, 0,1}, { 1, 1, 1, 1,1}, { 1, 1,-1, 1,0},
-    {-1, 1, 1, 0,1}, { 1, 1,-1, 1,0}, {-1, 1,-1, 0,0},
-    {-1,-1,-1, 0,1}, { 1,-1,-1, 1,1}, { 1,-1, 1, 1,0},
-    {-1,-1,-1, 0,1}, { 1,-1, 1, 1,0}, {-1,-1, 1, 0,0},
+// Four vertices per face, two triangles each.
+static constexpr std::array<Vertex, 24> kCube = {{
+    {-1,-1, 1, 0,1}, { 1,-1, 1, 1,1}, { 1, 1, 1, 1,0}, {-1, 1, 1, 0,0},
+    { 1,-1,-1, 0,1}, {-1,-1,-1, 1,1}, {-1, 1,-1, 1,0}, { 1, 1,-1, 0,0},
+    {-1,-1,-1, 0,1}, {-1,-1, 1, 1,1}, {-1, 1, 1, 1,0}, {-1, 1,-1, 0,0},
+    { 1,-1, 1, 0,1}, { 1,-1,-1, 1,1}, { 1, 1,-1, 1,0}, { 1, 1, 1, 0,0},
+    {-1, 1, 1, 0,1}, { 1, 1, 1, 1,1}, { 1, 1,-1, 1,0}, {-1, 1,-1, 0,0},
+    {-1,-1,-1, 0,1}, { 1,-1,-1, 1,1}, { 1,-1, 1, 1,0}, {-1,-1, 1, 0,0},
 }};
 
-static std::vector<uint32_t> compile_glsl_to_spv(const std::string& src, shaderc_shader_kind kind, const char* name)
+static constexpr std::array<uint16_t, kCubeIndexCount> kCubeIndices = {
+     0, 1, 2,  0, 2, 3,   4, 5, 6,  4, 6, 7,   8, 9,10,  8,10,11,
+    12,13,14, 12,14,15,  16,17,18, 16,18,19,  20,21,22, 20,22,23,
+};
+
+// Room for many per-draw uniform blocks per frame before the ring runs dry.
+static constexpr vk::DeviceSize kUniformRingBytesPerFrame = 64 * 1024;
+// Distance between neighbouring cube centers in the instance grid (cubes are 2 units wide).
+static constexpr float kInstanceSpacing = 3.0f;
+// Bounding sphere radius of a cube (half extent 1) under any rotation.
+static constexpr float kCubeRadius = 1.7320508f;
+
+static vk::DeviceSize align_up(vk::DeviceSize v, vk::DeviceSize a)
 {
-    shaderc::Compiler compiler;
-    shaderc::CompileOptions opts;
-    opts.SetOptimizationLevel(shaderc_optimization_level_performance);
-    auto result = compiler.CompileGlslToSpv(src, kind, name, opts);
-    if (result.GetCompilationStatus() != shaderc_compilation_status_success)
-        throw std::runtime_error(std::string("shaderc failed: ") + result.GetErrorMessage());
-    return { result.cbegin(), result.cend() };
+    return (v + a - 1) / a * a;
 }
 
-static void create_swapchain(AppState& s, IPlatformWindow& wnd);
-static void destroy_swapchain_deps(AppState& s);
+// Lays the instances out on a cube-shaped grid centered on the origin and sizes the per-frame
+// transform ring (the compacted visible buffer instead with --gpu-cull). One instance keeps the
+// original single cube at the origin.
+static void setup_instances(AppState& s)
+{
+    InstanceState& inst = s.instances;
+    inst.count = s.opts.instances;
+
+    const vk::DeviceSize bytes = vk::DeviceSize(inst.count) * sizeof(Mat4);
+    const uint32_t maxRange = s.pd.getProperties().limits.maxStorageBufferRange;
+    if (bytes > maxRange)
+        throw std::runtime_error("--instances " + std::to_string(inst.count) + " needs " + std::to_string(bytes)
+            + " bytes of transforms per frame; maxStorageBufferRange is " + std::to_string(maxRange));
+
+    uint32_t side = 1;
+    while (uint64_t(side) * side * side < inst.count) ++side;
+    const float half = float(side - 1) * kInstanceSpacing * 0.5f;
+
+    inst.positions.resize(inst.count);
+    for (uint32_t i=0;i<inst.count;++i)
+    {
+        const uint32_t x = i % side, y = (i / side) % side, z = i / (side * side);
+        inst.positions[i] = { float(x) * kInstanceSpacing - half, float(y) * kInstanceSpacing - half,
+                              float(z) * kInstanceSpacing - half };
+    }
+    inst.sceneRadius = half * std::sqrt(3.0f);
+
+    if (s.cull.enabled) return; // the GPU writes the transforms, see setup_gpu_cull
+    if (s.opts.cpuCull)
+    {
+        inst.culler = std::make_unique<CpuCuller>(s.jobs);
+        for (const auto& p : inst.positions) inst.bounds.push_back(p[0], p[1], p[2], kCubeRadius);
+        inst.visible.resize(inst.count);
+        std::cout << "[vkmini] CPU culling: " << inst.culler->threads() << " threads, " << cull_lanes() << " objects per instruction\n";
+    }
+    inst.transforms = create_frame_ring(s.pd, s.alloc, bytes, s.sync.framesInFlight,
+        vk::BufferUsageFlagBits::eStorageBuffer);
+    std::cout << "[vkmini] Instances: " << inst.count << " (" << side << "^3 grid, "
+              << (bytes * s.sync.framesInFlight) / (1024 * 1024) << " MiB transform ring)\n";
+}
 
-static void setup_instance(AppState& s)
+// Set layouts only: the pipelines need them, the sets need the assets. Split out so pipeline
+// creation does not wait for the uploads.
+static void create_descriptor_layouts(AppState& s)
 {
-    vk::ApplicationInfo appInfo("vkmini", VK_MAKE_VERSION(1,0,0), "none", VK_MAKE_VERSION(1,0,0), VK_API_VERSION_1_2);
+    const std::array<vk::DescriptorSetLayoutBinding,3> bindings = {
+        vk::DescriptorSetLayoutBinding{ 0, vk::DescriptorType::eUniformBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex },
+        vk::DescriptorSetLayoutBinding{ 1, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment },
+        vk::DescriptorSetLayoutBinding{ 2, vk::DescriptorType::eStorageBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex }
+    };
+    s.dsl = s.device->createDescriptorSetLayoutUnique(vk::DescriptorSetLayoutCreateInfo{
+        {}, (uint32_t)bindings.size(), bindings.data()
+    });
+    if (!s.cull.enabled) return;
+
+    const std::array<vk::DescriptorSetLayoutBinding,4> cullBindings = {
+        vk::DescriptorSetLayoutBinding{ 0, vk::DescriptorType::eUniformBufferDynamic, 1, vk::ShaderStageFlagBits::eCompute },
+        vk::DescriptorSetLayoutBinding{ 1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute },
+        vk::DescriptorSetLayoutBinding{ 2, vk::DescriptorType::eStorageBufferDynamic, 1, vk::ShaderStageFlagBits::eCompute },
+        vk::DescriptorSetLayoutBinding{ 3, vk::DescriptorType::eStorageBufferDynamic, 1, vk::ShaderStageFlagBits::eCompute }
+    };
+    s.cull.dsl = s.device->createDescriptorSetLayoutUnique(vk::DescriptorSetLayoutCreateInfo{
+        {}, (uint32_t)cullBindings.size(), cullBindings.data()
+    });
+}
+
+// --gpu-cull buffers: static bounding spheres (recorded into the pending upload batch), and the
+// per-frame compacted transforms and indirect args the compute pass writes.
+static void setup_gpu_cull(AppState& s)
+{
+    GpuCullState& c = s.cull;
+    const InstanceState& inst = s.instances;
+    const vk::DeviceSize align = s.pd.getProperties().limits.minStorageBufferOffsetAlignment;
+    const uint32_t frames = s.sync.framesInFlight;
+
+    std::vector<std::array<float,4>> spheres(inst.count);
+    for (uint32_t i=0;i<inst.count;++i)
+        spheres[i] = { inst.positions[i][0], inst.positions[i][1], inst.positions[i][2], kCubeRadius };
+    const vk::DeviceSize sphereBytes = spheres.size() * sizeof(spheres[0]);
+
+    auto objects = create_buffer(s.alloc, sphereBytes,
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    s.uploads.upload_buffer(objects.buf.get(), 0, spheres.data(), sphereBytes);
+
+    c.visibleStride = align_up(vk::DeviceSize(inst.count) * sizeof(Mat4), align);
+    c.argsStride = align_up(sizeof(CullArgs), align);
+    if (c.visibleStride * frames > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("--gpu-cull: visible buffer too large for 32-bit dynamic offsets");
+
+    auto visible = create_buffer(s.alloc, c.visibleStride * frames, vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    auto args = create_buffer(s.alloc, c.argsStride * frames,
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    c.objects.buf = std::move(objects.buf);
+    c.objects.mem = std::move(objects.mem);
+    c.visible.buf = std::move(visible.buf);
+    c.visible.mem = std::move(visible.mem);
+    c.args.buf = std::move(args.buf);
+    c.args.mem = std::move(args.mem);
+
+    std::array<vk::DescriptorPoolSize,3> sizes = {
+        vk::DescriptorPoolSize{ vk::DescriptorType::eUniformBufferDynamic, 1 },
+        vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, 1 },
+        vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBufferDynamic, 2 }
+    };
+    c.dpool = s.device->createDescriptorPoolUnique(vk::DescriptorPoolCreateInfo{
+        {}, 1, (uint32_t)sizes.size(), sizes.data()
+    });
+    c.dset = std::move(s.device->allocateDescriptorSetsUnique(vk::DescriptorSetAllocateInfo{
+        c.dpool.get(), 1, &c.dsl.get()
+    })[0]);
+
+    vk::DescriptorBufferInfo ubi{ s.ubo.buffer.buf.get(), 0, sizeof(CullUBO) };
+    vk::DescriptorBufferInfo obi{ c.objects.buf.get(), 0, sphereBytes };
+    vk::DescriptorBufferInfo vbi{ c.visible.buf.get(), 0, vk::DeviceSize(inst.count) * sizeof(Mat4) };
+    vk::DescriptorBufferInfo abi{ c.args.buf.get(), 0, sizeof(CullArgs) };
+    std::array<vk::WriteDescriptorSet,4> writes = {
+        vk::WriteDescriptorSet{ c.dset.get(), 0, 0, 1, vk::DescriptorType::eUniformBufferDynamic, nullptr, &ubi, nullptr },
+        vk::WriteDescriptorSet{ c.dset.get(), 1, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &obi, nullptr },
+        vk::WriteDescriptorSet{ c.dset.get(), 2, 0, 1, vk::DescriptorType::eStorageBufferDynamic, nullptr, &vbi, nullptr },
+        vk::WriteDescriptorSet{ c.dset.get(), 3, 0, 1, vk::DescriptorType::eStorageBufferDynamic, nullptr, &abi, nullptr }
+    };
+    s.device->updateDescriptorSets((uint32_t)writes.size(), writes.data(), 0, nullptr);
+
+    std::cout << "[vkmini] Instances: " << inst.count << " (GPU culled, "
+              << (c.visibleStride * frames) / (1024 * 1024) << " MiB visible buffer)\n";
+}
+
+static void create_swapchain(AppState& s, FramebufferSize fb, vk::SwapchainKHR old);
+
+// wnd: null for headless (no surface at all); a headless-surface window needs only
+// VK_EXT_headless_surface instead of the platform's surface extension.
+static void setup_instance(AppState& s, const IPlatformWindow* wnd)
+{
+    VKMINI_TRACE_ZONE("setup_instance");
+    vk::ApplicationInfo appInfo("vkmini", VK_MAKE_VERSION(1,0,0), "none", VK_MAKE_VERSION(1,0,0), VK_API_VERSION_1_3);
 
     auto vcfg = make_validation_config();
 
     std::vector<const char*> exts;
-    exts.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
-
+    if (wnd && wnd->native().headless)
+    {
+        exts.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+        exts.push_back(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+    }
+    else if (wnd)
+    {
+        exts.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
 #if defined(_WIN32)
-    exts.push_back("VK_KHR_win32_surface");
+        exts.push_back("VK_KHR_win32_surface");
 #elif defined(__ANDROID__)
-    exts.push_back("VK_KHR_android_surface");
+        exts.push_back("VK_KHR_android_surface");
 #else
-    exts.push_back("VK_KHR_xcb_surface");
+        exts.push_back("VK_KHR_xcb_surface");
 #endif
+    }
 
     for (auto e : vcfg.instance_exts) exts.push_back(e);
 
@@ -79,7 +227,20 @@ static void setup_instance(AppState& s)
 
 static void setup_surface(AppState& s, IPlatformWindow& wnd)
 {
+    VKMINI_TRACE_ZONE("setup_surface");
     auto n = wnd.native();
+    if (n.headless)
+    {
+        // Not exported by every loader, so resolved through the instance.
+        auto create = reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(s.instance->getProcAddr("vkCreateHeadlessSurfaceEXT"));
+        if (!create)
+            throw std::runtime_error("VK_EXT_headless_surface is not available.");
+        const VkHeadlessSurfaceCreateInfoEXT info{ VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT, nullptr, 0 };
+        VkSurfaceKHR surface = VK_NULL_HANDLE;
+        vk_check(vk::Result(create(s.instance.get(), &info, nullptr, &surface)), "vkCreateHeadlessSurfaceEXT");
+        s.surface = vk::UniqueSurfaceKHR(vk::SurfaceKHR(surface), s.instance.get());
+        return;
+    }
 #if defined(_WIN32)
     s.surface = s.instance->createWin32SurfaceKHRUnique(vk::Win32SurfaceCreateInfoKHR{ {}, (HINSTANCE)n.hinstance, (HWND)n.hwnd });
 #elif defined(__ANDROID__)
@@ -94,6 +255,7 @@ static void setup_surface(AppState& s, IPlatformWindow& wnd)
 
 static void setup_device(AppState& s)
 {
+    VKMINI_TRACE_ZONE("setup_device");
     auto devices = s.instance->enumeratePhysicalDevices();
     if (devices.empty()) throw std::runtime_error("No Vulkan physical devices");
 
@@ -103,74 +265,195 @@ static void setup_device(AppState& s)
     std::cout << "[Vulkan] Using: " << props.deviceName << " (vendor 0x" << std::hex << props.vendorID << std::dec << ")\n";
 
     s.graphicsQ = pick_graphics_qf(s.pd);
-    s.presentQ  = pick_present_qf(s.pd, s.surface.get());
+    s.presentQ  = s.surface ? pick_present_qf(s.pd, s.surface.get()) : s.graphicsQ;
 
-    std::set<uint32_t> unique = { s.graphicsQ, s.presentQ };
-    float prio = 1.0f;
-    std::vector<vk::DeviceQueueCreateInfo> qcis;
-    for (auto qf : unique) qcis.push_back(vk::DeviceQueueCreateInfo{ {}, qf, 1, &prio });
+    // Streaming uploads go to a dedicated transfer family when there is one, else to a second
+    // graphics queue, else to the graphics queue itself (shared under a lock).
+    const auto transferQf = pick_transfer_qf(s.pd);
+    const bool secondGraphics = !transferQf && s.pd.getQueueFamilyProperties()[s.graphicsQ].queueCount > 1;
+    s.transferQ = transferQf.value_or(s.graphicsQ);
 
-    std::vector<const char*> devExts = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    std::set<uint32_t> unique = { s.graphicsQ, s.presentQ, s.transferQ };
+    const std::array<float,2> prios = { 1.0f, 0.5f };
+    std::vector<vk::DeviceQueueCreateInfo> qcis;
+    for (auto qf : unique)
+        qcis.push_back(vk::DeviceQueueCreateInfo{ {}, qf, (qf == s.graphicsQ && secondGraphics) ? 2u : 1u, prios.data() });
+
+    std::vector<const char*> devExts;
+    if (s.surface) devExts.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    const bool creationFeedback = has_device_extension(s.pd, VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+    if (creationFeedback) devExts.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+
+    // Dynamic rendering: core in 1.3, else the KHR extension on 1.2 devices. The render pass path
+    // stays as the fallback and can be forced with VKMINI_FORCE_RENDERPASS=1.
+    const char* forceRp = std::getenv("VKMINI_FORCE_RENDERPASS");
+    const bool core13 = props.apiVersion >= VK_API_VERSION_1_3;
+    const bool drExt = !core13 && props.apiVersion >= VK_API_VERSION_1_2
+        && has_device_extension(s.pd, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    vk::PhysicalDeviceDynamicRenderingFeaturesKHR drFeatures{};
+    if ((core13 || drExt) && !(forceRp && *forceRp && *forceRp != '0'))
+    {
+        auto chain = s.pd.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDynamicRenderingFeaturesKHR>();
+        drFeatures.dynamicRendering = chain.get<vk::PhysicalDeviceDynamicRenderingFeaturesKHR>().dynamicRendering;
+    }
+    const bool dynamicRendering = drFeatures.dynamicRendering;
+    if (dynamicRendering && drExt) devExts.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+
+    // --gpu-cull draws with drawIndexedIndirectCount when available: a core 1.2 feature, else the
+    // KHR extension (no feature bit). Without either it falls back to plain drawIndexedIndirect.
+    const bool gpuCull = s.opts.gpuCull
+        && (s.pd.getQueueFamilyProperties()[s.graphicsQ].queueFlags & vk::QueueFlagBits::eCompute);
+    if (s.opts.gpuCull && !gpuCull)
+        std::cout << "[Vulkan] --gpu-cull ignored: the graphics queue family has no compute\n";
+    vk::PhysicalDeviceVulkan12Features v12Features{};
+    if (gpuCull && props.apiVersion >= VK_API_VERSION_1_2)
+    {
+        auto chain = s.pd.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+        v12Features.drawIndirectCount = chain.get<vk::PhysicalDeviceVulkan12Features>().drawIndirectCount;
+    }
+    const bool indirectCountExt = gpuCull && !v12Features.drawIndirectCount
+        && has_device_extension(s.pd, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    if (indirectCountExt) devExts.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
+    // Frame pacing runs on a timeline semaphore: core 1.2 (in the Vulkan12Features block), else the
+    // KHR extension with its own feature struct. There is no fence fallback.
+    vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+    const bool timelineExt = props.apiVersion < VK_API_VERSION_1_2
+        && has_device_extension(s.pd, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    if (props.apiVersion >= VK_API_VERSION_1_2)
+    {
+        auto chain = s.pd.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+        v12Features.timelineSemaphore = chain.get<vk::PhysicalDeviceVulkan12Features>().timelineSemaphore;
+    }
+    else if (timelineExt)
+    {
+        auto chain = s.pd.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR>();
+        timelineFeatures.timelineSemaphore = chain.get<vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR>().timelineSemaphore;
+    }
+    if (!v12Features.timelineSemaphore && !timelineFeatures.timelineSemaphore)
+        throw std::runtime_error("Timeline semaphores (Vulkan 1.2 or VK_KHR_timeline_semaphore) are required");
+    if (timelineExt) devExts.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+
+    // Pipeline statistics only back the profiler; don't enable the feature otherwise. With
+    // --record-threads the query spans executeCommands, which needs inheritedQueries as well.
+    const auto supported = s.pd.getFeatures();
+    vk::PhysicalDeviceFeatures features{};
+    features.pipelineStatisticsQuery = s.opts.gpuProfile && supported.pipelineStatisticsQuery
+        && (!s.opts.recordThreads || supported.inheritedQueries);
+    features.inheritedQueries = features.pipelineStatisticsQuery && s.opts.recordThreads;
+
+    void* featureChain = nullptr;
+    if (v12Features.drawIndirectCount || v12Features.timelineSemaphore) { v12Features.pNext = featureChain; featureChain = &v12Features; }
+    if (timelineFeatures.timelineSemaphore) { timelineFeatures.pNext = featureChain; featureChain = &timelineFeatures; }
+    if (dynamicRendering) { drFeatures.pNext = featureChain; featureChain = &drFeatures; }
 
     vk::DeviceCreateInfo dci{};
+    dci.pNext = featureChain;
+    dci.pEnabledFeatures = &features;
     dci.queueCreateInfoCount = (uint32_t)qcis.size();
     dci.pQueueCreateInfos = qcis.data();
     dci.enabledExtensionCount = (uint32_t)devExts.size();
     dci.ppEnabledExtensionNames = devExts.data();
 
     s.device = s.pd.createDeviceUnique(dci);
+    if (dynamicRendering)
+    {
+        s.render.dynamic = true;
+        s.render.beginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(
+            s.device->getProcAddr(core13 ? "vkCmdBeginRendering" : "vkCmdBeginRenderingKHR"));
+        s.render.endRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(
+            s.device->getProcAddr(core13 ? "vkCmdEndRendering" : "vkCmdEndRenderingKHR"));
+        if (!s.render.beginRendering || !s.render.endRendering)
+            throw std::runtime_error("vkCmdBeginRendering/vkCmdEndRendering not available");
+    }
+    if (gpuCull)
+    {
+        s.cull.enabled = true;
+        if (v12Features.drawIndirectCount || indirectCountExt)
+            s.cull.drawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCount>(
+                s.device->getProcAddr(indirectCountExt ? "vkCmdDrawIndexedIndirectCountKHR" : "vkCmdDrawIndexedIndirectCount"));
+        std::cout << "[Vulkan] GPU culling: " << (s.cull.drawIndexedIndirectCount ? "drawIndexedIndirectCount" : "drawIndexedIndirect") << "\n";
+    }
+    s.sync.timelineKhr = timelineExt;
+    std::cout << "[Vulkan] Rendering: " << (dynamicRendering ? (core13 ? "dynamic (1.3)" : "dynamic (KHR)") : "render pass") << "\n";
+    s.alloc.init(s.pd, s.device.get());
+    s.pipelineCache.load(s.pd, s.device.get(), PipelineCache::default_path(), creationFeedback);
     s.graphicsQueue = s.device->getQueue(s.graphicsQ, 0);
     s.presentQueue  = s.device->getQueue(s.presentQ, 0);
+    s.transferQueue = s.device->getQueue(s.transferQ, secondGraphics ? 1 : 0);
 
     s.cmdPool = s.device->createCommandPoolUnique(vk::CommandPoolCreateInfo{
         vk::CommandPoolCreateFlagBits::eResetCommandBuffer, s.graphicsQ
     });
-}
 
-static void setup_assets(AppState& s)
-{
-    // texture: simple checkerboard RGBA8
-    const uint32_t texW=256, texH=256;
-    std::vector<uint32_t> pixels(texW*texH);
-    for (uint32_t y=0;y<texH;++y)
-    for (uint32_t x=0;x<texW;++x)
+    if (s.opts.recordThreads)
     {
-        const bool on = (((x/32) ^ (y/32)) & 1) != 0;
-        const uint8_t c = on ? 255 : 32;
-        pixels[y*texW + x] = (uint32_t)c | ((uint32_t)c<<8) | ((uint32_t)c<<16) | (0xFFu<<24);
+        s.recorder.start(s.device.get(), s.graphicsQ, s.opts.recordThreads, s.sync.framesInFlight, s.jobs);
+        std::cout << "[Vulkan] Recording: up to " << s.recorder.slices() << " secondary command buffers on "
+                  << s.jobs.threads() << " job threads\n";
     }
 
-    const vk::DeviceSize bytes = pixels.size()*sizeof(uint32_t);
+    if (s.opts.gpuProfile)
+        s.gpu.init(s.pd, s.device.get(), s.graphicsQueue, s.graphicsQ, s.sync.framesInFlight,
+            features.pipelineStatisticsQuery);
 
-    auto staging = create_buffer(s.pd, s.device.get(), bytes,
-        vk::BufferUsageFlagBits::eTransferSrc,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    const bool sharesGraphics = !transferQf && !secondGraphics;
+    std::cout << "[Vulkan] Streaming uploads: " << (transferQf ? "dedicated transfer queue" : secondGraphics ? "second graphics queue" : "shared graphics queue") << "\n";
+    s.streaming.start(s.alloc, s.transferQueue, s.transferQ, s.graphicsQ, sharesGraphics);
+    s.uploads.init(s.alloc, s.graphicsQueue, s.graphicsQ, UploadContext::kDefaultStagingBytes,
+        VK_QUEUE_FAMILY_IGNORED, s.streaming.shared_queue_mutex());
+}
 
-    void* map = s.device->mapMemory(staging.mem.get(), 0, bytes);
-    std::memcpy(map, pixels.data(), (size_t)bytes);
-    s.device->unmapMemory(staging.mem.get());
+static constexpr uint32_t kTexSize = 256;
+
+// Checkerboard RGBA8, kTexSize squared, its columns shifted left by `shift` texels.
+static std::vector<uint32_t> make_texture(uint32_t shift = 0)
+{
+    VKMINI_TRACE_ZONE("make_texture");
+    std::vector<uint32_t> pixels(kTexSize*kTexSize);
+    for (uint32_t y=0;y<kTexSize;++y)
+    for (uint32_t x=0;x<kTexSize;++x)
+    {
+        const bool on = ((((x + shift % kTexSize)/32) ^ (y/32)) & 1) != 0;
+        const uint8_t c = on ? 255 : 32;
+        pixels[y*kTexSize + x] = (uint32_t)c | ((uint32_t)c<<8) | ((uint32_t)c<<16) | (0xFFu<<24);
+    }
+    return pixels;
+}
 
-    auto img = create_image(s.pd, s.device.get(), texW, texH,
+// `pixels` is filled by a job on `pixelsReady`; everything that does not need it goes first.
+static void setup_assets(AppState& s, JobCounter& pixelsReady, const std::vector<uint32_t>& pixels)
+{
+    VKMINI_TRACE_ZONE("setup_assets");
+    auto img = create_image(s.alloc, kTexSize, kTexSize,
         vk::Format::eR8G8B8A8Unorm, vk::ImageTiling::eOptimal,
         vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
         vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-    transition_image_layout(s.device.get(), s.graphicsQueue, s.cmdPool.get(),
-        img.img.get(), vk::Format::eR8G8B8A8Unorm, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-
-    copy_buffer_to_image(s.device.get(), s.graphicsQueue, s.cmdPool.get(), staging.buf.get(), img.img.get(), texW, texH);
-
-    transition_image_layout(s.device.get(), s.graphicsQueue, s.cmdPool.get(),
-        img.img.get(), vk::Format::eR8G8B8A8Unorm, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
-
-    s.tex.img = std::move(img.img);
-    s.tex.mem = std::move(img.mem);
-
     s.tex.view = s.device->createImageViewUnique(vk::ImageViewCreateInfo{
-        {}, s.tex.img.get(), vk::ImageViewType::e2D, vk::Format::eR8G8B8A8Unorm,
+        {}, img.img.get(), vk::ImageViewType::e2D, vk::Format::eR8G8B8A8Unorm,
         {}, vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0,1,0,1 }
     });
 
+    // --stream-texture: the copy the transfer queue rewrites. Filled by the first streamed upload,
+    // and not sampled before that.
+    TextureStream& ts = s.texStream;
+    ts.period = s.opts.streamTexture;
+    ts.nextUpload = ts.period;
+    if (ts.period)
+    {
+        auto copy = create_image(s.alloc, kTexSize, kTexSize,
+            vk::Format::eR8G8B8A8Unorm, vk::ImageTiling::eOptimal,
+            vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+            vk::MemoryPropertyFlagBits::eDeviceLocal);
+        ts.tex.view = s.device->createImageViewUnique(vk::ImageViewCreateInfo{
+            {}, copy.img.get(), vk::ImageViewType::e2D, vk::Format::eR8G8B8A8Unorm,
+            {}, vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0,1,0,1 }
+        });
+        ts.tex.img = std::move(copy.img);
+        ts.tex.mem = std::move(copy.mem);
+    }
+
     s.tex.sampler = s.device->createSamplerUnique(vk::SamplerCreateInfo{
         {},
         vk::Filter::eLinear, vk::Filter::eLinear,
@@ -178,100 +461,113 @@ static void setup_assets(AppState& s)
         vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat
     });
 
-    // VBO + UBO
+    // VBO + IBO + UBO
     const vk::DeviceSize vboBytes = sizeof(Vertex) * kCube.size();
+    const vk::DeviceSize iboBytes = sizeof(uint16_t) * kCubeIndices.size();
 
-    auto vboStage = create_buffer(s.pd, s.device.get(), vboBytes,
-        vk::BufferUsageFlagBits::eTransferSrc,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-
-    void* vmap = s.device->mapMemory(vboStage.mem.get(), 0, vboBytes);
-    std::memcpy(vmap, kCube.data(), (size_t)vboBytes);
-    s.device->unmapMemory(vboStage.mem.get());
-
-    auto vbo = create_buffer(s.pd, s.device.get(), vboBytes,
+    auto vbo = create_buffer(s.alloc, vboBytes,
         vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
         vk::MemoryPropertyFlagBits::eDeviceLocal);
+    auto ibo = create_buffer(s.alloc, iboBytes,
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-    copy_buffer(s.device.get(), s.graphicsQueue, s.cmdPool.get(), vboStage.buf.get(), vbo.buf.get(), vboBytes);
+    s.uploads.upload_buffer(vbo.buf.get(), 0, kCube.data(), vboBytes);
+    s.uploads.upload_buffer(ibo.buf.get(), 0, kCubeIndices.data(), iboBytes);
 
-    s.vbo.buf = std::move(vbo.buf);
-    s.vbo.mem = std::move(vbo.mem);
+    s.ubo = create_frame_ring(s.pd, s.alloc, kUniformRingBytesPerFrame,
+        s.sync.framesInFlight, vk::BufferUsageFlagBits::eUniformBuffer);
+    setup_instances(s);
+    if (s.cull.enabled) setup_gpu_cull(s);
 
-    auto ubo = create_buffer(s.pd, s.device.get(), sizeof(UBO),
-        vk::BufferUsageFlagBits::eUniformBuffer,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-    s.ubo.buf = std::move(ubo.buf);
-    s.ubo.mem = std::move(ubo.mem);
-
-    // descriptors
-    std::array<vk::DescriptorSetLayoutBinding,2> bindings = {
-        vk::DescriptorSetLayoutBinding{ 0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eVertex },
-        vk::DescriptorSetLayoutBinding{ 1, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment }
-    };
+    s.jobs.wait(pixelsReady);
+    s.uploads.upload_image(img.img.get(), kTexSize, kTexSize, pixels.data(), pixels.size() * sizeof(uint32_t));
 
-    s.dsl = s.device->createDescriptorSetLayoutUnique(vk::DescriptorSetLayoutCreateInfo{
-        {}, (uint32_t)bindings.size(), bindings.data()
-    });
+    // One submit for every asset. Frame submits on the same queue are ordered after it,
+    // so nothing waits here; the staging ring recycles once the batch retires.
+    s.uploads.submit();
 
-    std::array<vk::DescriptorPoolSize,2> sizes = {
-        vk::DescriptorPoolSize{ vk::DescriptorType::eUniformBuffer, 1 },
-        vk::DescriptorPoolSize{ vk::DescriptorType::eCombinedImageSampler, 1 }
+    s.tex.img = std::move(img.img);
+    s.tex.mem = std::move(img.mem);
+    s.vbo.buf = std::move(vbo.buf);
+    s.vbo.mem = std::move(vbo.mem);
+    s.ibo.buf = std::move(ibo.buf);
+    s.ibo.mem = std::move(ibo.mem);
+
+    // descriptors (layout from create_descriptor_layouts); a second set for the streamed copy
+    const uint32_t sets = ts.period ? 2u : 1u;
+    std::array<vk::DescriptorPoolSize,3> sizes = {
+        vk::DescriptorPoolSize{ vk::DescriptorType::eUniformBufferDynamic, sets },
+        vk::DescriptorPoolSize{ vk::DescriptorType::eCombinedImageSampler, sets },
+        vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBufferDynamic, sets }
     };
 
     s.dpool = s.device->createDescriptorPoolUnique(vk::DescriptorPoolCreateInfo{
-        {}, 1, (uint32_t)sizes.size(), sizes.data()
+        {}, sets, (uint32_t)sizes.size(), sizes.data()
     });
 
-    s.dset = std::move(s.device->allocateDescriptorSetsUnique(vk::DescriptorSetAllocateInfo{
-        s.dpool.get(), 1, &s.dsl.get()
-    })[0]);
-
-    vk::DescriptorBufferInfo dbi{ s.ubo.buf.get(), 0, sizeof(UBO) };
-    vk::DescriptorImageInfo dii{ s.tex.sampler.get(), s.tex.view.get(), vk::ImageLayout::eShaderReadOnlyOptimal };
-
-    std::array<vk::WriteDescriptorSet,2> writes = {
-        vk::WriteDescriptorSet{ s.dset.get(), 0, 0, 1, vk::DescriptorType::eUniformBuffer, nullptr, &dbi, nullptr },
-        vk::WriteDescriptorSet{ s.dset.get(), 1, 0, 1, vk::DescriptorType::eCombinedImageSampler, &dii, nullptr, nullptr }
+    const std::array<vk::DescriptorSetLayout,2> layouts = { s.dsl.get(), s.dsl.get() };
+    auto allocated = s.device->allocateDescriptorSetsUnique(vk::DescriptorSetAllocateInfo{
+        s.dpool.get(), sets, layouts.data()
+    });
+    s.dset = std::move(allocated[0]);
+    if (ts.period) ts.dset = std::move(allocated[1]);
+
+    // Dynamic UBO and instance SSBO: the per-frame slice offsets are supplied at bind time.
+    // With --gpu-cull the instances come from the compacted buffer the cull pass writes.
+    vk::DescriptorBufferInfo dbi{ s.ubo.buffer.buf.get(), 0, sizeof(UBO) };
+    const vk::Buffer instanceBuf = s.cull.enabled ? s.cull.visible.buf.get() : s.instances.transforms.buffer.buf.get();
+    vk::DescriptorBufferInfo ibi{ instanceBuf, 0, vk::DeviceSize(s.instances.count) * sizeof(Mat4) };
+
+    auto write_set = [&](vk::DescriptorSet set, vk::ImageView view) {
+        vk::DescriptorImageInfo dii{ s.tex.sampler.get(), view, vk::ImageLayout::eShaderReadOnlyOptimal };
+        std::array<vk::WriteDescriptorSet,3> writes = {
+            vk::WriteDescriptorSet{ set, 0, 0, 1, vk::DescriptorType::eUniformBufferDynamic, nullptr, &dbi, nullptr },
+            vk::WriteDescriptorSet{ set, 1, 0, 1, vk::DescriptorType::eCombinedImageSampler, &dii, nullptr, nullptr },
+            vk::WriteDescriptorSet{ set, 2, 0, 1, vk::DescriptorType::eStorageBufferDynamic, nullptr, &ibi, nullptr }
+        };
+        s.device->updateDescriptorSets((uint32_t)writes.size(), writes.data(), 0, nullptr);
     };
-    s.device->updateDescriptorSets((uint32_t)writes.size(), writes.data(), 0, nullptr);
+    write_set(s.dset.get(), s.tex.view.get());
+    if (ts.period) write_set(ts.dset.get(), ts.tex.view.get());
 }
 
-void setup_pipeline(AppState& s)
+void stream_texture(AppState& s)
 {
-    // Renderpass created in swapchain build.
-    // Pipeline uses current swapchain extent.
-    const std::string vertSrc = R"glsl(
-        #version 450
-        layout(location=0) in vec3 inPos;
-        layout(location=1) in vec2 inUV;
-        layout(binding=0) uniform UBO { mat4 mvp; } ubo;
-        layout(location=0) out vec2 vUV;
-        void main() {
-            gl_Position = ubo.mvp * vec4(inPos, 1.0);
-            vUV = inUV;
-        }
-    )glsl";
-
-    const std::string fragSrc = R"glsl(
-        #version 450
-        layout(location=0) in vec2 vUV;
-        layout(location=0) out vec4 outColor;
-        layout(binding=1) uniform sampler2D texSampler;
-        void main() {
-            outColor = texture(texSampler, vUV);
-        }
-    )glsl";
-
-    auto vertSpv = compile_glsl_to_spv(vertSrc, shaderc_glsl_vertex_shader, "vert");
-    auto fragSpv = compile_glsl_to_spv(fragSrc, shaderc_glsl_fragment_shader, "frag");
+    TextureStream& ts = s.texStream;
+    if (!ts.period) return;
+    // The acquire just recorded into this frame covers the pending upload: sample the new copy.
+    if (ts.pending && s.streaming.acquired() >= ts.pending)
+    {
+        ts.front ^= 1;
+        ts.pending = 0;
+        ++ts.uploads;
+    }
+    const uint64_t value = s.sync.pacer.frame_value();
+    ts.lastUse[ts.front] = value;
+
+    // The back copy is overwritten (its old contents discarded) only once no frame samples it.
+    const uint32_t back = ts.front ^ 1;
+    if (ts.pending || value < ts.nextUpload || s.sync.pacer.completed() < ts.lastUse[back]) return;
+    VKMINI_TRACE_ZONE("stream texture");
+    ts.phase += 4;
+    const std::vector<uint32_t> pixels = make_texture(ts.phase);
+    std::vector<std::byte> bytes(pixels.size() * sizeof(uint32_t));
+    std::memcpy(bytes.data(), pixels.data(), bytes.size());
+    ts.pending = s.streaming.upload_image(back ? ts.tex.img.get() : s.tex.img.get(), kTexSize, kTexSize, std::move(bytes));
+    ts.nextUpload = value + ts.period;
+}
 
-    auto vert = s.device->createShaderModuleUnique(vk::ShaderModuleCreateInfo{ {}, vertSpv.size()*4, vertSpv.data() });
-    auto frag = s.device->createShaderModuleUnique(vk::ShaderModuleCreateInfo{ {}, fragSpv.size()*4, fragSpv.data() });
+static void setup_pipeline(AppState& s)
+{
+    VKMINI_TRACE_ZONE("setup_pipeline");
+    // Renderpass created in swapchain build. Modules and layout are created once and kept.
+    if (!s.pipe.vert) s.pipe.vert = create_shader_module(s.device.get(), ShaderId::CubeVert);
+    if (!s.pipe.frag) s.pipe.frag = create_shader_module(s.device.get(), ShaderId::CubeFrag);
 
     vk::PipelineShaderStageCreateInfo stages[2] = {
-        vk::PipelineShaderStageCreateInfo{ {}, vk::ShaderStageFlagBits::eVertex, vert.get(), "main" },
-        vk::PipelineShaderStageCreateInfo{ {}, vk::ShaderStageFlagBits::eFragment, frag.get(), "main" }
+        vk::PipelineShaderStageCreateInfo{ {}, vk::ShaderStageFlagBits::eVertex, s.pipe.vert.get(), "main" },
+        vk::PipelineShaderStageCreateInfo{ {}, vk::ShaderStageFlagBits::eFragment, s.pipe.frag.get(), "main" }
     };
 
     vk::VertexInputBindingDescription bind{ 0, sizeof(Vertex), vk::VertexInputRate::eVertex };
@@ -283,9 +579,10 @@ void setup_pipeline(AppState& s)
     vk::PipelineVertexInputStateCreateInfo vi{ {}, 1, &bind, (uint32_t)attr.size(), attr.data() };
     vk::PipelineInputAssemblyStateCreateInfo ia{ {}, vk::PrimitiveTopology::eTriangleList, false };
 
-    vk::Viewport vp{ 0,0, (float)s.sc.extent.width, (float)s.sc.extent.height, 0,1 };
-    vk::Rect2D sc{ {0,0}, s.sc.extent };
-    vk::PipelineViewportStateCreateInfo vpState{ {}, 1, &vp, 1, &sc };
+    // Set per frame with setViewport/setScissor.
+    vk::PipelineViewportStateCreateInfo vpState{ {}, 1, nullptr, 1, nullptr };
+    const std::array<vk::DynamicState,2> dyn = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
+    vk::PipelineDynamicStateCreateInfo dynState{ {}, (uint32_t)dyn.size(), dyn.data() };
 
     // IMPORTANT: we flip Y in projection; that flips winding.
     // Keep backface culling, but treat clockwise as front.
@@ -309,9 +606,14 @@ void setup_pipeline(AppState& s)
     };
     vk::PipelineColorBlendStateCreateInfo cb{ {}, false, vk::LogicOp::eCopy, 1, &ba };
 
-    s.pipe.pipelineLayout = s.device->createPipelineLayoutUnique(vk::PipelineLayoutCreateInfo{
-        {}, 1, &s.dsl.get(), 0, nullptr
-    });
+    if (!s.pipe.pipelineLayout)
+        s.pipe.pipelineLayout = s.device->createPipelineLayoutUnique(vk::PipelineLayoutCreateInfo{
+            {}, 1, &s.dsl.get(), 0, nullptr
+        });
+
+    // Without a render pass the attachment formats are declared on the pipeline instead.
+    const vk::Format colorFmt = s.sc.surfFmt.format;
+    vk::PipelineRenderingCreateInfoKHR rendering{ 0, 1, &colorFmt, s.depth.depthFmt, vk::Format::eUndefined };
 
     vk::GraphicsPipelineCreateInfo gpi{
         {}, 2, stages,
@@ -319,30 +621,54 @@ void setup_pipeline(AppState& s)
         nullptr,
         &vpState,
         &rs, &ms, &ds, &cb,
-        nullptr,
+        &dynState,
         s.pipe.pipelineLayout.get(),
         s.pipe.renderPass.get(),
         0
     };
+    if (s.render.dynamic) gpi.pNext = &rendering;
+
+    s.pipe.pipeline = s.pipelineCache.create_graphics(gpi, "cube");
 
-    s.pipe.pipeline = s.device->createGraphicsPipelineUnique({}, gpi).value;
+    // The cull pass does not depend on the targets and survives every rebuild.
+    if (s.cull.enabled && !s.cull.pipeline)
+    {
+        if (!s.cull.shader) s.cull.shader = create_shader_module(s.device.get(), ShaderId::CullComp);
+        s.cull.layout = s.device->createPipelineLayoutUnique(vk::PipelineLayoutCreateInfo{
+            {}, 1, &s.cull.dsl.get(), 0, nullptr
+        });
+        vk::ComputePipelineCreateInfo cpi{
+            {}, vk::PipelineShaderStageCreateInfo{ {}, vk::ShaderStageFlagBits::eCompute, s.cull.shader.get(), "main" },
+            s.cull.layout.get()
+        };
+        s.cull.pipeline = s.pipelineCache.create_compute(cpi, "cull");
+    }
 }
 
 static void setup_sync(AppState& s)
 {
-    using S = SyncState;
-    for (uint32_t i=0;i<S::kMaxFramesInFlight;++i)
-    {
-        s.sync.imageAvailable[i] = s.device->createSemaphoreUnique(vk::SemaphoreCreateInfo{});
-        s.sync.renderFinished[i] = s.device->createSemaphoreUnique(vk::SemaphoreCreateInfo{});
-        s.sync.frameFence[i] = s.device->createFenceUnique(vk::FenceCreateInfo{ vk::FenceCreateFlagBits::eSignaled });
-    }
+    VKMINI_TRACE_ZONE("setup_sync");
+    s.sync.pacer.init(s.device.get(), s.sync.framesInFlight, s.sync.timelineKhr);
+    if (!s.surface) return; // headless: no acquire
+    s.sync.imageAvailable.clear();
+    for (uint32_t i=0;i<s.sync.framesInFlight;++i)
+        s.sync.imageAvailable.push_back(s.device->createSemaphoreUnique(vk::SemaphoreCreateInfo{}));
+}
+
+// Per swapchain image, so rebuilt with the swapchain.
+static void create_image_sync(AppState& s)
+{
+    s.sync.imageValue.assign(s.sc.images.size(), 0);
+    s.sync.renderFinished.clear();
+    if (!s.surface) return; // headless: no present
+    for (size_t i=0;i<s.sc.images.size();++i)
+        s.sync.renderFinished.push_back(s.device->createSemaphoreUnique(vk::SemaphoreCreateInfo{}));
 }
 
 static void create_depth(AppState& s)
 {
-    s.depth.depthFmt = find_depth_format(s.pd);
-    auto img = create_image(s.pd, s.device.get(),
+    if (s.depth.depthFmt == vk::Format::eUndefined) s.depth.depthFmt = find_depth_format(s.pd);
+    auto img = create_image(s.alloc,
         s.sc.extent.width, s.sc.extent.height,
         s.depth.depthFmt, vk::ImageTiling::eOptimal,
         vk::ImageUsageFlagBits::eDepthStencilAttachment,
@@ -357,13 +683,14 @@ static void create_depth(AppState& s)
     });
 }
 
-static void create_renderpass(AppState& s)
+// The scene pass, leaving the color target in finalLayout.
+static vk::UniqueRenderPass create_renderpass(AppState& s, vk::ImageLayout finalLayout)
 {
     const vk::AttachmentDescription colorAtt(
         {}, s.sc.surfFmt.format, vk::SampleCountFlagBits::e1,
         vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore,
         vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eDontCare,
-        vk::ImageLayout::eUndefined, vk::ImageLayout::ePresentSrcKHR);
+        vk::ImageLayout::eUndefined, finalLayout);
 
     const vk::AttachmentDescription depthAtt(
         {}, s.depth.depthFmt, vk::SampleCountFlagBits::e1,
@@ -383,20 +710,30 @@ static void create_renderpass(AppState& s)
         nullptr,
         &depthRef);
 
-    vk::SubpassDependency dep(
-        VK_SUBPASS_EXTERNAL, 0,
-        vk::PipelineStageFlagBits::eColorAttachmentOutput,
-        vk::PipelineStageFlagBits::eColorAttachmentOutput,
-        {}, vk::AccessFlagBits::eColorAttachmentWrite);
+    const std::array<vk::SubpassDependency,2> deps = {
+        vk::SubpassDependency(
+            VK_SUBPASS_EXTERNAL, 0,
+            vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            {}, vk::AccessFlagBits::eColorAttachmentWrite),
+        // Headless readback and the live-resize blit copy the target after the pass.
+        vk::SubpassDependency(
+            0, VK_SUBPASS_EXTERNAL,
+            vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferRead)
+    };
+    const uint32_t depCount = finalLayout == vk::ImageLayout::ePresentSrcKHR ? 1u : 2u;
 
-    s.pipe.renderPass = s.device->createRenderPassUnique(vk::RenderPassCreateInfo{
-        {}, (uint32_t)atts.size(), atts.data(), 1, &subpass, 1, &dep
+    return s.device->createRenderPassUnique(vk::RenderPassCreateInfo{
+        {}, (uint32_t)atts.size(), atts.data(), 1, &subpass, depCount, deps.data()
     });
 }
 
-void create_framebuffers(AppState& s)
+static void create_framebuffers(AppState& s)
 {
     s.pipe.framebuffers.clear();
+    if (s.render.dynamic) return;
     s.pipe.framebuffers.reserve(s.sc.views.size());
 
     for (auto& v : s.sc.views)
@@ -409,20 +746,37 @@ void create_framebuffers(AppState& s)
     }
 }
 
-void create_cmd_buffers(AppState& s)
+static void create_cmd_buffers(AppState& s)
 {
     s.cmdBuffers = s.device->allocateCommandBuffersUnique(vk::CommandBufferAllocateInfo{
-        s.cmdPool.get(), vk::CommandBufferLevel::ePrimary, (uint32_t)s.pipe.framebuffers.size()
+        s.cmdPool.get(), vk::CommandBufferLevel::ePrimary, (uint32_t)s.sc.images.size()
     });
 }
 
-static void create_swapchain(AppState& s, IPlatformWindow& wnd)
+// Everything sized or formatted after the color targets in s.sc. The render pass and pipeline
+// are kept when they already exist (a resize that keeps the surface format).
+static void create_target_deps(AppState& s)
 {
-    // Wait until we have a non-zero drawable size (minimized windows report 0x0).
-    while (!VKMINI_HEADLESS && wnd.is_minimized())
-        wnd.wait_events();
+    VKMINI_TRACE_ZONE("create_target_deps");
+    create_depth(s);
+    if (!s.render.dynamic && !s.pipe.renderPass)
+        s.pipe.renderPass = create_renderpass(s, s.sc.finalLayout);
+    // Compatible with the scene pass, so the pipeline and secondaries work with either.
+    if (!s.render.dynamic && s.blit.supported && !s.blit.renderPass)
+        s.blit.renderPass = create_renderpass(s, vk::ImageLayout::eTransferSrcOptimal);
+    if (!s.pipe.pipeline)
+        setup_pipeline(s);
+    create_framebuffers(s);
+    create_cmd_buffers(s);
 
-    const auto fb = wnd.framebuffer_size();
+    create_image_sync(s);
+}
+
+// fb: the window's current (non-zero) framebuffer size. `old` (may be null) is retired by the new
+// swapchain: its presents still in flight complete, but no more images can be acquired from it.
+static void create_swapchain(AppState& s, FramebufferSize fb, vk::SwapchainKHR old)
+{
+    VKMINI_TRACE_ZONE("create_swapchain");
 
     const auto caps = s.pd.getSurfaceCapabilitiesKHR(s.surface.get());
     const auto formats = s.pd.getSurfaceFormatsKHR(s.surface.get());
@@ -430,6 +784,13 @@ static void create_swapchain(AppState& s, IPlatformWindow& wnd)
 
     s.sc.surfFmt = pick_surface_format(formats);
     s.sc.presentMode = pick_present_mode(modes);
+    if (!old)
+    {
+        const vk::FormatFeatureFlags blit = vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst
+                                          | vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+        s.blit.supported = (caps.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferDst)
+                        && (s.pd.getFormatProperties(s.sc.surfFmt.format).optimalTilingFeatures & blit) == blit;
+    }
 
     vk::Extent2D extent{};
     if (caps.currentExtent.width != std::numeric_limits<uint32_t>::max())
@@ -440,19 +801,22 @@ static void create_swapchain(AppState& s, IPlatformWindow& wnd)
             std::clamp(fb.h, caps.minImageExtent.height, caps.maxImageExtent.height)
         };
     s.sc.extent = extent;
+    s.sc.windowSize = vk::Extent2D{ fb.w, fb.h };
+    s.sc.suboptimal = false;
+    s.sc.outOfDate = false;
 
-    uint32_t minCount = std::max(2u, caps.minImageCount);
-    uint32_t maxCount = (caps.maxImageCount == 0) ? minCount : caps.maxImageCount;
-    uint32_t imageCount = std::min(minCount, maxCount);
+    const uint32_t imageCount = pick_image_count(caps, s.opts.swapchainImages);
 
     std::array<uint32_t,2> families = { s.graphicsQ, s.presentQ };
     const bool concurrent = s.graphicsQ != s.presentQ;
+    vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eColorAttachment;
+    if (s.blit.supported) usage |= vk::ImageUsageFlagBits::eTransferDst; // live-resize blits
 
     vk::SwapchainCreateInfoKHR sci(
         {}, s.surface.get(), imageCount,
         s.sc.surfFmt.format, s.sc.surfFmt.colorSpace,
         s.sc.extent,
-        1, vk::ImageUsageFlagBits::eColorAttachment,
+        1, usage,
         concurrent ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
         concurrent ? (uint32_t)families.size() : 0u,
         concurrent ? families.data() : nullptr,
@@ -460,11 +824,14 @@ static void create_swapchain(AppState& s, IPlatformWindow& wnd)
         vk::CompositeAlphaFlagBitsKHR::eOpaque,
         s.sc.presentMode,
         true,
-        s.sc.swapchain ? s.sc.swapchain.get() : vk::SwapchainKHR{}
+        old
     );
 
     s.sc.swapchain = s.device->createSwapchainKHRUnique(sci);
     s.sc.images = s.device->getSwapchainImagesKHR(s.sc.swapchain.get());
+    if (!s.blit.active) // not on every step of a live resize
+        std::cout << "[Vulkan] Swapchain: " << s.sc.images.size() << " images, " << vk::to_string(s.sc.presentMode)
+                  << ", " << s.sync.framesInFlight << " frames in flight\n";
 
     s.sc.views.clear();
     s.sc.views.reserve(s.sc.images.size());
@@ -475,46 +842,198 @@ static void create_swapchain(AppState& s, IPlatformWindow& wnd)
             {}, vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0,1,0,1 }
         }));
     }
-
-    // Recreate dependent resources
-    create_depth(s);
-    create_renderpass(s);
-    setup_pipeline(s);
-    create_framebuffers(s);
-    create_cmd_buffers(s);
-
-    s.sync.imagesInFlight.assign(s.sc.images.size(), vk::Fence{});
 }
 
-static void destroy_swapchain_deps(AppState& s)
+// No waitIdle when rebuilding: the frames already submitted keep their images, views, framebuffers,
+// depth buffer and command buffers, which are retired through the pacer once those frames have.
+
+// Retires the swapchain and its per-image objects and builds the swapchain for fb. Returns the
+// previous surface format.
+static vk::Format replace_swapchain(AppState& s, FramebufferSize fb)
 {
-    s.device->waitIdle();
+    FramePacer& pacer = s.sync.pacer;
+    pacer.defer(std::move(s.cmdBuffers));
+    pacer.defer(std::move(s.pipe.framebuffers));
+    pacer.defer(std::move(s.sc.views));
     s.cmdBuffers.clear();
     s.pipe.framebuffers.clear();
-    s.pipe.pipeline.reset();
-    s.pipe.pipelineLayout.reset();
-    s.pipe.renderPass.reset();
-    s.depth.view.reset();
-    s.depth.img.reset();
-    s.depth.mem.reset();
     s.sc.views.clear();
     s.sc.images.clear();
-    s.sc.swapchain.reset();
+
+    // The last presents wait on these semaphores, and a present has no completion signal of its
+    // own: keep them, and the swapchain they present to, until the frame after the last one
+    // submitted has retired (a later submit on the queue completes after the earlier present's
+    // semaphore wait; with a separate present queue this is the usual frame of slack).
+    const uint64_t presentsDone = pacer.submitted() + 1;
+    pacer.defer(presentsDone, std::move(s.sync.renderFinished));
+    s.sync.renderFinished.clear();
+    vk::UniqueSwapchainKHR old = std::move(s.sc.swapchain);
+
+    const vk::Format oldFmt = s.sc.surfFmt.format;
+    create_swapchain(s, fb, old.get());
+    pacer.defer(presentsDone, std::move(old));
+    return oldFmt;
+}
+
+// Retires the size-dependent targets (and the live-resize scene target) and rebuilds them, with the
+// pipeline too when the surface format changed (the pipeline uses dynamic viewport/scissor).
+static void rebuild_targets(AppState& s, vk::Format oldFmt)
+{
+    FramePacer& pacer = s.sync.pacer;
+    pacer.defer(std::move(s.depth.view));
+    pacer.defer(std::move(s.depth.img));
+    pacer.defer(std::move(s.depth.mem));
+    if (s.blit.view)
+    {
+        pacer.defer(std::move(s.blit.framebuffer));
+        pacer.defer(std::move(s.blit.view));
+        pacer.defer(std::move(s.blit.color));
+    }
+    s.blit.active = false;
+    if (s.sc.surfFmt.format != oldFmt)
+    {
+        pacer.defer(std::move(s.pipe.pipeline));
+        pacer.defer(std::move(s.pipe.renderPass));
+        pacer.defer(std::move(s.blit.renderPass));
+    }
+    create_target_deps(s);
+}
+
+void recreate_swapchain(AppState& s, FramebufferSize fb)
+{
+    VKMINI_TRACE_ZONE("recreate_swapchain");
+    s.blit.active = false; // log the new swapchain
+    rebuild_targets(s, replace_swapchain(s, fb));
+}
+
+void resize_swapchain_scaled(AppState& s, FramebufferSize fb)
+{
+    VKMINI_TRACE_ZONE("resize_swapchain_scaled");
+    if (!s.blit.active)
+    {
+        // The scene target takes over the swapchain's role at the current size, next to the depth
+        // buffer of that size.
+        s.blit.extent = s.sc.extent;
+        s.blit.color = create_image(s.alloc, s.blit.extent.width, s.blit.extent.height, s.sc.surfFmt.format,
+            vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+            vk::MemoryPropertyFlagBits::eDeviceLocal);
+        s.blit.view = s.device->createImageViewUnique(vk::ImageViewCreateInfo{
+            {}, s.blit.color.img.get(), vk::ImageViewType::e2D, s.sc.surfFmt.format,
+            {}, vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0,1,0,1 } });
+        if (!s.render.dynamic)
+        {
+            const std::array<vk::ImageView,2> views = { s.blit.view.get(), s.depth.view.get() };
+            s.blit.framebuffer = s.device->createFramebufferUnique(vk::FramebufferCreateInfo{
+                {}, s.blit.renderPass.get(), (uint32_t)views.size(), views.data(),
+                s.blit.extent.width, s.blit.extent.height, 1 });
+        }
+        s.blit.active = true;
+    }
+
+    const vk::Format oldFmt = replace_swapchain(s, fb);
+    if (s.sc.surfFmt.format != oldFmt)
+    {
+        rebuild_targets(s, oldFmt); // the scene target no longer matches: a full rebuild
+        return;
+    }
+    // The swapchain framebuffers are not drawn to until the settled rebuild replaces them.
+    create_cmd_buffers(s);
+    create_image_sync(s);
 }
 
-void setup(AppState& s, IPlatformWindow& wnd)
+// Startup as a dependency graph on the job system, every node timed into s.startup:
+//
+//   spirv (per shader) ---------------------------> modules --+
+//   checkerboard ----------------------> assets (uploads)     |
+//   instance -> surface -> device -> layouts -+--> assets      |
+//                                             +--> swapchain --+--> targets + pipelines -> sync
+//
+// The setup thread keeps the instance/device/swapchain chain (surface and window calls stay on
+// the thread that owns the window) and the pipelines; CPU-only preparation starts before the
+// instance exists, and the asset uploads record and submit on a job while pipelines compile.
+void setup(AppState& s, IPlatformWindow* wnd)
 {
-    setup_instance(s);
+    VKMINI_TRACE_ZONE("setup");
+    s.sync.framesInFlight = s.opts.framesInFlight;
+    StartupReport& r = s.startup;
+    r.add("launch, window", StartupReport::process_start(), StartupReport::Clock::now());
+
+    // Declared before the job groups that write them, so the groups drain first on unwind.
+    std::array<std::vector<uint32_t>, 3> spirv;
+    std::vector<uint32_t> pixels;
+    ScopedJobs spirvJobs(s.jobs), pixelJobs(s.jobs), moduleJobs(s.jobs), assetJobs(s.jobs), queryJobs(s.jobs);
+
+    const ShaderId shaders[] = { ShaderId::CubeVert, ShaderId::CubeFrag, ShaderId::CullComp };
+    for (uint32_t i=0;i<(s.opts.gpuCull ? 3u : 2u);++i)
+        spirvJobs.run([&, i] {
+            StartupReport::Phase p(r, i == 0 ? "spirv cube.vert" : i == 1 ? "spirv cube.frag" : "spirv cull.comp");
+            spirv[i] = load_shader_spirv(shaders[i]);
+        });
+    pixelJobs.run([&] {
+        StartupReport::Phase p(r, "checkerboard");
+        pixels = make_texture();
+    });
 
-    DebugMessenger dbg = create_debug_messenger(s.instance.get());
-    // Store destroy function + handle via raw, no lifetime issue (instance outlives app).
-    // We keep it local; destroying at end is handled in run.
+    DebugMessenger dbg{};
+    {
+        StartupReport::Phase p(r, "instance");
+        setup_instance(s, wnd);
+        dbg = create_debug_messenger(s.instance.get());
+        // Store destroy function + handle via raw, no lifetime issue (instance outlives app).
+        // We keep it local; destroying at end is handled in run.
+    }
+    if (wnd)
+    {
+        StartupReport::Phase p(r, "surface");
+        setup_surface(s, *wnd);
+    }
+    {
+        StartupReport::Phase p(r, "device");
+        setup_device(s);
+        create_descriptor_layouts(s);
+    }
+
+    s.jobs.run_after(spirvJobs.counter(), &moduleJobs.counter(), [&] {
+        StartupReport::Phase p(r, "shader modules");
+        s.pipe.vert = create_shader_module(s.device.get(), spirv[0]);
+        s.pipe.frag = create_shader_module(s.device.get(), spirv[1]);
+        if (s.cull.enabled) s.cull.shader = create_shader_module(s.device.get(), spirv[2]);
+    });
+    assetJobs.run([&] {
+        StartupReport::Phase p(r, "assets");
+        setup_assets(s, pixelJobs.counter(), pixels);
+    });
+    queryJobs.run([&] {
+        StartupReport::Phase p(r, "depth format");
+        s.depth.depthFmt = find_depth_format(s.pd);
+    });
 
-    setup_surface(s, wnd);
-    setup_device(s);
-    setup_assets(s);
-    create_swapchain(s, wnd);
-    setup_sync(s);
+    {
+        StartupReport::Phase p(r, wnd ? "swapchain" : "offscreen targets");
+        if (wnd)
+        {
+            // Minimized windows report 0x0, which no swapchain can have.
+            while (wnd->is_minimized())
+                wnd->wait_events(IPlatformWindow::kNoTimeout);
+            create_swapchain(s, wnd->framebuffer_size(), nullptr);
+        }
+        else create_offscreen_targets(s);
+    }
+    queryJobs.wait();
+    moduleJobs.wait();
+    {
+        StartupReport::Phase p(r, "targets, pipelines");
+        create_target_deps(s);
+    }
+    {
+        StartupReport::Phase p(r, "sync");
+        setup_sync(s);
+    }
+    {
+        StartupReport::Phase p(r, "wait assets");
+        assetJobs.wait();
+    }
+    r.setup_done();
 
     // keep messenger alive by stashing in static? simplest: leakless lambda in run handles destroy; run owns it.
     // We'll expose through thread_local globals:
@@ -1,18 +1,9 @@
 #include "vk_device_select.hpp"
 #include "vk_helpers.hpp"
-#include <cstring>
 #include <stdexcept>
 
 namespace vkmini {
 
-static bool supports_swapchain(vk::PhysicalDevice pd)
-{
-    for (const auto& e : pd.enumerateDeviceExtensionProperties())
-        if (std::strcmp(e.extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0)
-            return true;
-    return false;
-}
-
 vk::PhysicalDevice pick_best_device(const std::vector<vk::PhysicalDevice>& devices, vk::SurfaceKHR surface)
 {
     vk::PhysicalDevice best{};
@@ -20,15 +11,15 @@ vk::PhysicalDevice pick_best_device(const std::vector<vk::PhysicalDevice>& devic
 
     for (auto pd : devices)
     {
-        if (!supports_swapchain(pd)) continue;
+        if (surface && !has_device_extension(pd, VK_KHR_SWAPCHAIN_EXTENSION_NAME)) continue;
 
-        // Require graphics + present queue families.
+        // Require graphics + present queue families (present only with a surface).
         const auto qfps = pd.getQueueFamilyProperties();
-        bool hasG=false, hasP=false;
+        bool hasG=false, hasP=!surface;
         for (uint32_t i=0;i<(uint32_t)qfps.size();++i)
         {
             if (qfps[i].queueFlags & vk::QueueFlagBits::eGraphics) hasG=true;
-            if (pd.getSurfaceSupportKHR(i, surface)) hasP=true;
+            if (surface && pd.getSurfaceSupportKHR(i, surface)) hasP=true;
         }
         if (!hasG || !hasP) continue;
 
@@ -0,0 +1,90 @@
+#include "vk_frame_pacer.hpp"
+#include "vk_check.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace vkmini {
+
+void FramePacer::init(vk::Device dev, uint32_t framesInFlight, bool khr)
+{
+    dev_ = dev;
+    frames_ = framesInFlight;
+    frame_ = 0;
+    submitted_ = 0;
+    slotValue_.assign(frames_, 0);
+
+    vk::SemaphoreTypeCreateInfo type{ vk::SemaphoreType::eTimeline, 0 };
+    timeline_ = dev_.createSemaphoreUnique(vk::SemaphoreCreateInfo{ {}, &type });
+    waitSemaphores_ = reinterpret_cast<PFN_vkWaitSemaphores>(
+        dev_.getProcAddr(khr ? "vkWaitSemaphoresKHR" : "vkWaitSemaphores"));
+    counterValue_ = reinterpret_cast<PFN_vkGetSemaphoreCounterValue>(
+        dev_.getProcAddr(khr ? "vkGetSemaphoreCounterValueKHR" : "vkGetSemaphoreCounterValue"));
+    if (!waitSemaphores_ || !counterValue_)
+        throw std::runtime_error("timeline semaphore entry points not available");
+}
+
+uint64_t FramePacer::completed() const
+{
+    uint64_t value = 0;
+    vk_check(vk::Result(counterValue_(dev_, timeline_.get(), &value)), "vkGetSemaphoreCounterValue");
+    return value;
+}
+
+void FramePacer::wait(uint64_t value)
+{
+    if (!value) return;
+    const VkSemaphore sem = timeline_.get();
+    const VkSemaphoreWaitInfo info{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO, nullptr, 0, 1, &sem, &value };
+    vk_check(vk::Result(waitSemaphores_(dev_, &info, std::numeric_limits<uint64_t>::max())), "vkWaitSemaphores");
+}
+
+void FramePacer::begin_frame()
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    const uint64_t done = completed();
+    const uint64_t queued = submitted_ - std::min(done, submitted_);
+    VKMINI_TRACE_COUNTER("gpu frames queued", queued);
+    if (submitted_)
+    {
+        ++sampled_;
+        queued_ += queued;
+        if (!queued) ++starved_;
+    }
+
+    if (done < slotValue_[frame_]) wait(slotValue_[frame_]);
+    const uint64_t retired = std::max(done, slotValue_[frame_]);
+    std::erase_if(deferred_, [retired](const Deferred& d) { return d.value <= retired; });
+
+    const auto t1 = std::chrono::steady_clock::now();
+    if (lastBegin_ != std::chrono::steady_clock::time_point{})
+    {
+        stalledMs_ += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        frameMs_ += std::chrono::duration<double, std::milli>(t0 - lastBegin_).count();
+    }
+    lastBegin_ = t0;
+}
+
+void FramePacer::end_frame()
+{
+    slotValue_[frame_] = ++submitted_;
+    frame_ = (frame_ + 1) % frames_;
+}
+
+std::string FramePacer::format_summary() const
+{
+    if (!sampled_) return {};
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(1);
+    // A frame that starts with nothing queued leaves the GPU idle while the CPU records it.
+    os << "[vkmini] Frame pacing: " << frames_ << " frames in flight; GPU had " << std::setprecision(2)
+       << double(queued_) / double(sampled_) << " frames queued at frame start, CPU-GPU overlap "
+       << std::setprecision(1) << 100.0 * double(sampled_ - starved_) / double(sampled_) << "% of frames, CPU stalled on the GPU "
+       << (frameMs_ > 0 ? 100.0 * stalledMs_ / frameMs_ : 0.0) << "% of the time\n";
+    return os.str();
+}
+
+} // namespace vkmini
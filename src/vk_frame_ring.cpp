@@ -0,0 +1,51 @@
+#include "vk_frame_ring.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace vkmini {
+
+static vk::DeviceSize align_up(vk::DeviceSize v, vk::DeviceSize a)
+{
+    return (v + a - 1) / a * a;
+}
+
+FrameRing create_frame_ring(vk::PhysicalDevice pd, DeviceAllocator& alloc, vk::DeviceSize bytesPerFrame, uint32_t frames, vk::BufferUsageFlags usage)
+{
+    const auto limits = pd.getProperties().limits;
+
+    FrameRing r{};
+    if (usage & vk::BufferUsageFlagBits::eUniformBuffer)
+        r.alignment = std::max(r.alignment, limits.minUniformBufferOffsetAlignment);
+    if (usage & vk::BufferUsageFlagBits::eStorageBuffer)
+        r.alignment = std::max(r.alignment, limits.minStorageBufferOffsetAlignment);
+
+    r.frames = frames;
+    r.frameStride = align_up(bytesPerFrame, r.alignment);
+    if (r.frameStride * frames > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("frame ring too large for 32-bit dynamic offsets");
+
+    r.buffer = create_buffer(alloc, r.frameStride * frames, usage,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    r.mapped = static_cast<std::byte*>(r.buffer.mem.mapped());
+    return r;
+}
+
+void frame_ring_begin(FrameRing& r, uint32_t frame)
+{
+    r.frame = frame % r.frames;
+    r.head = 0;
+}
+
+FrameRingSlice frame_ring_alloc(FrameRing& r, vk::DeviceSize bytes)
+{
+    const vk::DeviceSize size = align_up(bytes, r.alignment);
+    if (r.head + size > r.frameStride)
+        throw std::runtime_error("frame ring exhausted");
+
+    const vk::DeviceSize offset = r.frame * r.frameStride + r.head;
+    r.head += size;
+    return FrameRingSlice{ r.mapped + offset, (uint32_t)offset };
+}
+
+} // namespace vkmini
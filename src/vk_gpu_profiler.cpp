@@ -0,0 +1,195 @@
+#include "vk_gpu_profiler.hpp"
+#include "vk_check.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace vkmini {
+
+static constexpr vk::QueryPipelineStatisticFlags kStatFlags =
+    vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+    vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+    vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+    vk::QueryPipelineStatisticFlagBits::eClippingInvocations |
+    vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+    vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations;
+static constexpr uint32_t kStatCount = 6; // results come back in flag bit order
+
+void GpuProfiler::init(vk::PhysicalDevice pd, vk::Device dev, vk::Queue queue, uint32_t queueFamily,
+                       uint32_t frames, bool pipelineStats)
+{
+    const uint32_t validBits = pd.getQueueFamilyProperties()[queueFamily].timestampValidBits;
+    if (validBits == 0)
+    {
+        std::cout << "[Vulkan] GPU profiler disabled: queue family " << queueFamily << " has no timestamps\n";
+        return;
+    }
+
+    dev_ = dev;
+    nsPerTick_ = pd.getProperties().limits.timestampPeriod;
+    tickMask_ = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+    slots_.resize(frames);
+    for (auto& slot : slots_)
+    {
+        slot.timestamps = dev_.createQueryPoolUnique(vk::QueryPoolCreateInfo{
+            {}, vk::QueryType::eTimestamp, kMaxZones * 2 });
+        if (pipelineStats)
+            slot.statistics = dev_.createQueryPoolUnique(vk::QueryPoolCreateInfo{
+                {}, vk::QueryType::ePipelineStatistics, 1, kStatFlags });
+    }
+    enabled_ = true;
+    calibrate(queue, queueFamily);
+}
+
+// One timestamp written at the bottom of an otherwise empty submit, bracketed by CPU clock reads.
+// The midpoint is taken as the CPU time of that tick.
+void GpuProfiler::calibrate(vk::Queue queue, uint32_t queueFamily)
+{
+    auto pool = dev_.createCommandPoolUnique(vk::CommandPoolCreateInfo{ vk::CommandPoolCreateFlagBits::eTransient, queueFamily });
+    auto cb = std::move(dev_.allocateCommandBuffersUnique(vk::CommandBufferAllocateInfo{
+        pool.get(), vk::CommandBufferLevel::ePrimary, 1 })[0]);
+    const vk::QueryPool qp = slots_[0].timestamps.get();
+
+    cb->begin(vk::CommandBufferBeginInfo{ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+    cb->resetQueryPool(qp, 0, 1);
+    cb->writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, qp, 0);
+    cb->end();
+
+    auto fence = dev_.createFenceUnique(vk::FenceCreateInfo{});
+    vk::CommandBuffer cbh = cb.get();
+    const uint64_t before = trace::now_ns();
+    queue.submit(vk::SubmitInfo{ 0,nullptr,nullptr, 1,&cbh }, fence.get());
+    VK_CHECK(dev_.waitForFences(fence.get(), true, std::numeric_limits<uint64_t>::max()));
+    const uint64_t after = trace::now_ns();
+
+    uint64_t tick = 0;
+    VK_CHECK(dev_.getQueryPoolResults(qp, 0, 1, sizeof(tick), &tick, sizeof(tick), vk::QueryResultFlagBits::e64));
+    gpuEpoch_ = tick & tickMask_;
+    cpuEpochNs_ = before + (after - before) / 2;
+}
+
+uint64_t GpuProfiler::to_ns(uint64_t ticks) const
+{
+    // Signed delta so timestamps before the epoch (never expected) don't wrap.
+    const double deltaTicks = double(int64_t((ticks & tickMask_) - gpuEpoch_));
+    return cpuEpochNs_ + int64_t(deltaTicks * nsPerTick_);
+}
+
+void GpuProfiler::resolve(Slot& slot)
+{
+    slot.pending = false;
+    if (slot.zones)
+    {
+        std::array<uint64_t, kMaxZones * 2> ticks{};
+        // The slot's frame has retired, so this returns immediately; eNotReady means a zone was begun
+        // but never ended, and the frame is skipped.
+        const vk::Result r = dev_.getQueryPoolResults(slot.timestamps.get(), 0, slot.zones * 2,
+            slot.zones * 2 * sizeof(uint64_t), ticks.data(), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+        if (r == vk::Result::eSuccess)
+        {
+            for (uint32_t z=0;z<slot.zones;++z)
+            {
+                const char* name = slot.names[z];
+                const uint64_t begin = to_ns(ticks[z*2]), end = to_ns(ticks[z*2 + 1]);
+                auto it = std::find_if(totals_.begin(), totals_.end(), [&](const Total& t) { return std::strcmp(t.name, name) == 0; });
+                if (it == totals_.end())
+                {
+                    totals_.push_back(Total{ name, 0.0, 0 });
+                    it = totals_.end() - 1;
+                }
+                it->ns += double(int64_t(end - begin));
+                it->count++;
+                if (trace::active())
+                {
+                    if (!track_) track_ = trace::track("GPU graphics queue");
+                    trace::zone(track_, name, begin, end);
+                }
+            }
+        }
+    }
+
+    if (slot.statsWritten)
+    {
+        std::array<uint64_t, kStatCount> v{};
+        const vk::Result r = dev_.getQueryPoolResults(slot.statistics.get(), 0, 1, sizeof(v), v.data(), sizeof(v),
+            vk::QueryResultFlagBits::e64);
+        if (r == vk::Result::eSuccess)
+            stats_ = PipelineStats{ v[0], v[1], v[2], v[3], v[4], v[5] };
+    }
+}
+
+void GpuProfiler::begin_frame(uint32_t frame, vk::CommandBuffer cb)
+{
+    if (!enabled_) return;
+    current_ = frame;
+    Slot& slot = slots_[frame];
+    if (slot.pending) resolve(slot);
+
+    cb.resetQueryPool(slot.timestamps.get(), 0, kMaxZones * 2);
+    if (slot.statistics) cb.resetQueryPool(slot.statistics.get(), 0, 1);
+    slot.zones = 0;
+    slot.statsWritten = false;
+    slot.pending = true;
+}
+
+void GpuProfiler::finish()
+{
+    for (auto& slot : slots_)
+        if (slot.pending) resolve(slot);
+}
+
+uint32_t GpuProfiler::begin_zone(vk::CommandBuffer cb, const char* name)
+{
+    if (!enabled_) return ~0u;
+    Slot& slot = slots_[current_];
+    if (slot.zones == kMaxZones) return ~0u;
+    const uint32_t z = slot.zones++;
+    slot.names[z] = name;
+    cb.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, slot.timestamps.get(), z * 2);
+    return z;
+}
+
+void GpuProfiler::end_zone(vk::CommandBuffer cb, uint32_t zone)
+{
+    if (!enabled_ || zone == ~0u) return;
+    cb.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, slots_[current_].timestamps.get(), zone * 2 + 1);
+}
+
+void GpuProfiler::begin_stats(vk::CommandBuffer cb)
+{
+    if (!enabled_ || !slots_[current_].statistics) return;
+    cb.beginQuery(slots_[current_].statistics.get(), 0, {});
+}
+
+void GpuProfiler::end_stats(vk::CommandBuffer cb)
+{
+    if (!enabled_ || !slots_[current_].statistics) return;
+    cb.endQuery(slots_[current_].statistics.get(), 0);
+    slots_[current_].statsWritten = true;
+}
+
+vk::QueryPipelineStatisticFlags GpuProfiler::inherited_statistics() const
+{
+    return enabled_ && slots_[current_].statistics ? kStatFlags : vk::QueryPipelineStatisticFlags{};
+}
+
+std::string GpuProfiler::format_summary() const
+{
+    if (!enabled_) return {};
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(3);
+    for (const Total& t : totals_)
+        os << "[Vulkan] GPU " << t.name << ": " << (t.count ? t.ns / t.count / 1e6 : 0.0)
+           << " ms avg over " << t.count << " frames\n";
+    if (slots_[0].statistics)
+        os << "[Vulkan] Last frame: " << stats_.iaVertices << " vertices, " << stats_.iaPrimitives << " primitives, "
+           << stats_.vsInvocations << " VS invocations, " << stats_.clipPrimitives << " clipped primitives, "
+           << stats_.fsInvocations << " FS invocations\n";
+    return os.str();
+}
+
+} // namespace vkmini
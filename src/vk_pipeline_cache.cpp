@@ -0,0 +1,171 @@
+#include "vk_pipeline_cache.hpp"
+#include "trace.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+#include <vector>
+
+namespace vkmini {
+
+// VkPipelineCacheHeaderVersionOne: headerSize, headerVersion, vendorID, deviceID (uint32 each),
+// then pipelineCacheUUID. Read field by field, the struct layout is not guaranteed to be packed.
+static constexpr size_t kHeaderBytes = 16 + VK_UUID_SIZE;
+
+static uint32_t read_u32(const std::vector<char>& blob, size_t at)
+{
+    uint32_t v = 0;
+    std::memcpy(&v, blob.data() + at, sizeof(v));
+    return v;
+}
+
+static bool header_matches(const std::vector<char>& blob, const vk::PhysicalDeviceProperties& props, std::string& why)
+{
+    if (blob.size() < kHeaderBytes) { why = "truncated header"; return false; }
+
+    const uint32_t headerSize = read_u32(blob, 0);
+    const uint32_t version    = read_u32(blob, 4);
+    if (headerSize < kHeaderBytes || headerSize > blob.size()) { why = "bad header size"; return false; }
+    if (version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) { why = "unknown header version"; return false; }
+    if (read_u32(blob, 8) != props.vendorID)  { why = "different vendor"; return false; }
+    if (read_u32(blob, 12) != props.deviceID) { why = "different device"; return false; }
+    if (std::memcmp(blob.data() + 16, props.pipelineCacheUUID.data(), VK_UUID_SIZE) != 0)
+    {
+        why = "different driver build";
+        return false;
+    }
+    return true;
+}
+
+std::filesystem::path PipelineCache::default_path()
+{
+    if (const char* env = std::getenv("VKMINI_PIPELINE_CACHE"); env && *env)
+        return env;
+    return "vkmini_pipeline_cache.bin";
+}
+
+void PipelineCache::load(vk::PhysicalDevice pd, vk::Device dev, std::filesystem::path path, bool creationFeedback)
+{
+    dev_ = dev;
+    props_ = pd.getProperties();
+    path_ = std::move(path);
+    feedback_ = creationFeedback;
+
+    std::vector<char> blob;
+    if (std::ifstream in{ path_, std::ios::binary })
+        blob.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    std::string why;
+    if (!blob.empty() && !header_matches(blob, props_, why))
+    {
+        std::cout << "[Vulkan] Pipeline cache " << path_.string() << " ignored (" << why << ")\n";
+        blob.clear();
+    }
+
+    try
+    {
+        cache_ = dev_.createPipelineCacheUnique(vk::PipelineCacheCreateInfo{ {}, blob.size(), blob.data() });
+    }
+    catch (const vk::SystemError& e)
+    {
+        // A header can match and the payload still be rejected; start from an empty cache.
+        std::cout << "[Vulkan] Pipeline cache rejected by driver: " << e.what() << "\n";
+        blob.clear();
+        cache_ = dev_.createPipelineCacheUnique(vk::PipelineCacheCreateInfo{});
+    }
+
+    if (!blob.empty())
+        std::cout << "[Vulkan] Pipeline cache loaded: " << blob.size() << " bytes from " << path_.string() << "\n";
+    dirty_ = blob.empty();
+}
+
+template <class CreateInfo, class Create>
+vk::UniquePipeline PipelineCache::create_with_feedback(const CreateInfo& ci, const char* name, Create&& create)
+{
+    VKMINI_TRACE_ZONE("create pipeline");
+    CreateInfo info = ci;
+    vk::PipelineCreationFeedbackEXT feedback{};
+    vk::PipelineCreationFeedbackCreateInfoEXT feedbackInfo{ &feedback, 0, nullptr };
+    if (feedback_)
+    {
+        feedbackInfo.pNext = info.pNext;
+        info.pNext = &feedbackInfo;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    auto pipeline = create(info);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    const bool valid = feedback_ && (feedback.flags & vk::PipelineCreationFeedbackFlagBitsEXT::eValid);
+    const bool hit = valid && (feedback.flags & vk::PipelineCreationFeedbackFlagBitsEXT::eApplicationPipelineCacheHit);
+
+    stats_.created++;
+    if (hit) { stats_.hits++;   stats_.hitMs += ms; }
+    else     { stats_.misses++; stats_.missMs += ms; dirty_ = true; }
+
+    std::cout << "[Vulkan] Pipeline " << name << ": " << ms << " ms ("
+              << (hit ? "cache hit" : valid ? "cache miss" : "no feedback") << ")\n";
+    return pipeline;
+}
+
+vk::UniquePipeline PipelineCache::create_graphics(const vk::GraphicsPipelineCreateInfo& ci, const char* name)
+{
+    return create_with_feedback(ci, name, [&](const vk::GraphicsPipelineCreateInfo& info) {
+        return dev_.createGraphicsPipelineUnique(cache_.get(), info).value;
+    });
+}
+
+vk::UniquePipeline PipelineCache::create_compute(const vk::ComputePipelineCreateInfo& ci, const char* name)
+{
+    return create_with_feedback(ci, name, [&](const vk::ComputePipelineCreateInfo& info) {
+        return dev_.createComputePipelineUnique(cache_.get(), info).value;
+    });
+}
+
+bool PipelineCache::save()
+{
+    if (!cache_ || !dirty_) return true;
+
+    const auto data = dev_.getPipelineCacheData(cache_.get());
+    auto tmp = path_;
+    tmp += ".tmp";
+    {
+        std::ofstream out{ tmp, std::ios::binary | std::ios::trunc };
+        out.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+        out.flush();
+        if (!out)
+        {
+            std::cerr << "[Vulkan] Pipeline cache: cannot write " << tmp.string() << "\n";
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, path_, ec);
+    if (ec)
+    {
+        std::cerr << "[Vulkan] Pipeline cache: cannot replace " << path_.string() << ": " << ec.message() << "\n";
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    dirty_ = false;
+    std::cout << "[Vulkan] Pipeline cache saved: " << data.size() << " bytes to " << path_.string() << "\n";
+    return true;
+}
+
+std::string PipelineCache::format_stats() const
+{
+    std::ostringstream os;
+    os << "[Vulkan] Pipelines: " << stats_.created << " created, "
+       << stats_.hits << " cache hits (" << stats_.hitMs << " ms), "
+       << stats_.misses << " misses (" << stats_.missMs << " ms)";
+    if (!feedback_) os << ", no creation feedback";
+    os << "\n";
+    return os.str();
+}
+
+} // namespace vkmini
@@ -0,0 +1,62 @@
+#include "vk_recorder.hpp"
+#include "trace.hpp"
+#include <algorithm>
+
+namespace vkmini {
+
+// Below this many draws per slice the handoff costs more than recording the draws inline.
+static constexpr uint32_t kMinDrawsPerSlice = 64;
+
+void ParallelRecorder::start(vk::Device dev, uint32_t queueFamily, uint32_t slices, uint32_t frames, JobSystem& jobs)
+{
+    dev_ = dev;
+    jobs_ = &jobs;
+    slices_ = std::max(1u, slices);
+    frames_ = frames;
+
+    slots_.resize(size_t(slices_) * frames_);
+    for (auto& slot : slots_)
+    {
+        slot.pool = dev_.createCommandPoolUnique(vk::CommandPoolCreateInfo{
+            vk::CommandPoolCreateFlagBits::eTransient, queueFamily });
+        slot.cb = dev_.allocateCommandBuffers(vk::CommandBufferAllocateInfo{
+            slot.pool.get(), vk::CommandBufferLevel::eSecondary, 1 })[0];
+    }
+}
+
+const std::vector<vk::CommandBuffer>& ParallelRecorder::record(uint32_t frame, const vk::CommandBufferInheritanceInfo& inheritance,
+                                                                 uint32_t drawCount, const RecordFn& fn)
+{
+    recorded_.clear();
+    if (!drawCount) return recorded_;
+
+    frame %= frames_;
+    const uint32_t slices = std::clamp(drawCount / kMinDrawsPerSlice, 1u, slices_);
+    const uint32_t slice = (drawCount + slices - 1) / slices;
+    const auto record_slice = [&](uint32_t i) {
+        VKMINI_TRACE_ZONE("record slice");
+        Slot& slot = slots_[size_t(i) * frames_ + frame];
+        const uint32_t begin = std::min(drawCount, i * slice);
+        const uint32_t end = std::min(drawCount, begin + slice);
+
+        // The frame's timeline value has been reached, so everything this pool handed out is idle.
+        dev_.resetCommandPool(slot.pool.get());
+        slot.cb.begin(vk::CommandBufferBeginInfo{
+            vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+            &inheritance });
+        fn(slot.cb, begin, end);
+        slot.cb.end();
+    };
+    {
+        ScopedJobs group(*jobs_);
+        for (uint32_t i=1;i<slices;++i) group.run([&record_slice, i] { record_slice(i); });
+        record_slice(0);
+        group.wait();
+    }
+
+    for (uint32_t i=0;i<slices;++i)
+        recorded_.push_back(slots_[size_t(i) * frames_ + frame].cb);
+    return recorded_;
+}
+
+} // namespace vkmini
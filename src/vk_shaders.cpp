@@ -0,0 +1,94 @@
+#include "vk_shaders.hpp"
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+#if VKMINI_RUNTIME_SHADERC
+#include <shaderc/shaderc.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#endif
+
+namespace vkmini {
+
+#if VKMINI_RUNTIME_SHADERC
+
+struct ShaderSource { const char* file; shaderc_shader_kind kind; };
+
+static ShaderSource source_of(ShaderId id)
+{
+    switch (id)
+    {
+    case ShaderId::CubeVert: return { "cube.vert", shaderc_glsl_vertex_shader };
+    case ShaderId::CubeFrag: return { "cube.frag", shaderc_glsl_fragment_shader };
+    case ShaderId::CullComp: return { "cull.comp", shaderc_glsl_compute_shader };
+    }
+    throw std::runtime_error("unknown shader id");
+}
+
+static std::vector<uint32_t> shader_spirv(ShaderId id)
+{
+    static shaderc::Compiler compiler; // thread-safe: setup compiles modules as parallel jobs
+
+    const ShaderSource src = source_of(id);
+    const std::string path = std::string(VKMINI_SHADER_DIR) + "/" + src.file;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot open shader source: " + path);
+    std::ostringstream text;
+    text << in.rdbuf();
+
+    shaderc::CompileOptions opts;
+    opts.SetOptimizationLevel(shaderc_optimization_level_performance);
+    auto result = compiler.CompileGlslToSpv(text.str(), src.kind, src.file, opts);
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+        throw std::runtime_error(std::string("shaderc failed: ") + result.GetErrorMessage());
+
+    return { result.cbegin(), result.cend() };
+}
+
+#else
+
+// glslc -mfmt=c output: a braced initializer list of SPIR-V words.
+static constexpr uint32_t kCubeVert[] =
+#include "cube.vert.spv.inc"
+;
+static constexpr uint32_t kCubeFrag[] =
+#include "cube.frag.spv.inc"
+;
+static constexpr uint32_t kCullComp[] =
+#include "cull.comp.spv.inc"
+;
+
+static std::span<const uint32_t> shader_spirv(ShaderId id)
+{
+    switch (id)
+    {
+    case ShaderId::CubeVert: return kCubeVert;
+    case ShaderId::CubeFrag: return kCubeFrag;
+    case ShaderId::CullComp: return kCullComp;
+    }
+    throw std::runtime_error("unknown shader id");
+}
+
+#endif
+
+vk::UniqueShaderModule create_shader_module(vk::Device dev, ShaderId id)
+{
+    const auto spirv = shader_spirv(id); // owning vector in dev mode, static span otherwise
+    return create_shader_module(dev, std::span<const uint32_t>(spirv));
+}
+
+std::vector<uint32_t> load_shader_spirv(ShaderId id)
+{
+    const auto spirv = shader_spirv(id);
+    return { spirv.begin(), spirv.end() };
+}
+
+vk::UniqueShaderModule create_shader_module(vk::Device dev, std::span<const uint32_t> spirv)
+{
+    return dev.createShaderModuleUnique(vk::ShaderModuleCreateInfo{ {}, spirv.size_bytes(), spirv.data() });
+}
+
+} // namespace vkmini
@@ -0,0 +1,177 @@
+#include "vk_streaming.hpp"
+#include "trace.hpp"
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+namespace vkmini {
+
+void StreamingUploader::start(DeviceAllocator& alloc, vk::Queue transferQueue, uint32_t transferFamily,
+                              uint32_t graphicsFamily, bool sharesGraphicsQueue)
+{
+    dev_ = alloc.device();
+    queue_ = transferQueue;
+    sharesGraphics_ = sharesGraphicsQueue;
+    ctx_.init(alloc, transferQueue, transferFamily, UploadContext::kDefaultStagingBytes, graphicsFamily, &queueMutex_);
+    thread_ = std::thread([this] { worker(); });
+}
+
+void StreamingUploader::stop()
+{
+    if (!thread_.joinable()) return;
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+
+    auto q = lock_queue();
+    queue_.waitIdle();
+}
+
+uint64_t StreamingUploader::upload_buffer(vk::Buffer dst, vk::DeviceSize dstOffset, std::vector<std::byte> data)
+{
+    uint64_t id = 0;
+    {
+        std::lock_guard lock(mutex_);
+        id = ++lastRequest_;
+        requests_.push_back(Request{ dst, dstOffset, vk::Image{}, 0, 0, std::move(data), id });
+    }
+    cv_.notify_one();
+    return id;
+}
+
+uint64_t StreamingUploader::upload_image(vk::Image dst, uint32_t w, uint32_t h, std::vector<std::byte> data)
+{
+    uint64_t id = 0;
+    {
+        std::lock_guard lock(mutex_);
+        id = ++lastRequest_;
+        requests_.push_back(Request{ vk::Buffer{}, 0, dst, w, h, std::move(data), id });
+    }
+    cv_.notify_one();
+    return id;
+}
+
+vk::UniqueSemaphore StreamingUploader::take_semaphore()
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (!freeSemaphores_.empty())
+        {
+            auto sem = std::move(freeSemaphores_.back());
+            freeSemaphores_.pop_back();
+            return sem;
+        }
+    }
+    return dev_.createSemaphoreUnique(vk::SemaphoreCreateInfo{});
+}
+
+void StreamingUploader::worker()
+{
+    VKMINI_TRACE_THREAD_NAME("streaming");
+    // Batches still executing own their semaphores, and the transfer queue may still be using
+    // them: wait before `submitted` destroys them, whether the loop ends on stop or on an error.
+    std::deque<Handoff> submitted;
+    try
+    {
+        process(submitted);
+        for (const auto& h : submitted) ctx_.wait(h.ticket);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[Vulkan] streaming thread stopped: " << e.what() << "\n";
+        try
+        {
+            auto q = lock_queue();
+            queue_.waitIdle();
+        }
+        catch (const std::exception&) {} // device lost: nothing left to wait for
+    }
+}
+
+void StreamingUploader::process(std::deque<Handoff>& submitted)
+{
+    for (;;)
+    {
+        std::deque<Request> batch;
+        {
+            std::unique_lock lock(mutex_);
+            const auto wake = [&] { return stop_ || !requests_.empty(); };
+            // Poll while batches are in flight so completions are published promptly.
+            if (submitted.empty()) cv_.wait(lock, wake);
+            else cv_.wait_for(lock, std::chrono::milliseconds(1), wake);
+            if (stop_) return;
+            batch.swap(requests_);
+        }
+
+        if (!batch.empty())
+        {
+            VKMINI_TRACE_ZONE("upload batch");
+            VKMINI_TRACE_COUNTER("upload batch requests", batch.size());
+            for (auto& r : batch)
+            {
+                if (r.image) ctx_.upload_image(r.image, r.w, r.h, r.data.data(), r.data.size());
+                else         ctx_.upload_buffer(r.buffer, r.offset, r.data.data(), r.data.size());
+            }
+            Handoff h{};
+            h.done = take_semaphore();
+            h.ticket = ctx_.submit(h.done.get(), &h.acquire);
+            h.lastRequest = batch.back().id;
+            submitted.push_back(std::move(h));
+        }
+
+        while (!submitted.empty() && ctx_.is_complete(submitted.front().ticket))
+        {
+            std::lock_guard lock(mutex_);
+            ready_.push_back(std::move(submitted.front()));
+            submitted.pop_front();
+        }
+    }
+}
+
+void StreamingUploader::begin_frame(uint32_t frame)
+{
+    if (frame >= frameSemaphores_.size()) frameSemaphores_.resize(frame + 1);
+    auto& used = frameSemaphores_[frame];
+    if (used.empty()) return;
+
+    std::lock_guard lock(mutex_);
+    for (auto& sem : used) freeSemaphores_.push_back(std::move(sem));
+    used.clear();
+}
+
+void StreamingUploader::acquire(uint32_t frame, vk::CommandBuffer cb,
+                                std::vector<vk::Semaphore>& waitSemaphores, std::vector<vk::PipelineStageFlags>& waitStages)
+{
+    std::vector<Handoff> ready;
+    {
+        std::lock_guard lock(mutex_);
+        if (ready_.empty()) return;
+        ready.swap(ready_);
+    }
+    if (frame >= frameSemaphores_.size()) frameSemaphores_.resize(frame + 1);
+
+    std::vector<vk::BufferMemoryBarrier> buffers;
+    std::vector<vk::ImageMemoryBarrier> images;
+    for (auto& h : ready)
+    {
+        // Already signaled (the batch completed), so this wait only orders the acquires.
+        waitSemaphores.push_back(h.done.get());
+        waitStages.push_back(vk::PipelineStageFlagBits::eAllCommands);
+        buffers.insert(buffers.end(), h.acquire.buffers.begin(), h.acquire.buffers.end());
+        images.insert(images.end(), h.acquire.images.begin(), h.acquire.images.end());
+        frameSemaphores_[frame].push_back(std::move(h.done));
+        acquired_ = h.lastRequest;
+    }
+
+    if (!buffers.empty() || !images.empty())
+        cb.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands, {},
+            0,nullptr,
+            (uint32_t)buffers.size(), buffers.data(),
+            (uint32_t)images.size(), images.data());
+}
+
+} // namespace vkmini
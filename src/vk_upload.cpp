@@ -0,0 +1,205 @@
+#include "vk_upload.hpp"
+#include "vk_check.hpp"
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <utility>
+
+namespace vkmini {
+
+// Satisfies the 4-byte bufferOffset rule for copyBufferToImage and common texel sizes.
+static constexpr vk::DeviceSize kStagingAlign = 16;
+
+void UploadContext::init(DeviceAllocator& alloc, vk::Queue queue, uint32_t queueFamily, vk::DeviceSize stagingBytes,
+                         uint32_t ownerFamily, std::mutex* queueMutex)
+{
+    alloc_ = &alloc;
+    dev_ = alloc.device();
+    queue_ = queue;
+    family_ = queueFamily;
+    ownerFamily_ = ownerFamily;
+    queueMutex_ = queueMutex;
+    pool_ = dev_.createCommandPoolUnique(vk::CommandPoolCreateInfo{
+        vk::CommandPoolCreateFlagBits::eTransient, queueFamily
+    });
+    ring_ = StagingRing(stagingBytes, kStagingAlign);
+    staging_ = create_buffer(alloc, stagingBytes, vk::BufferUsageFlagBits::eTransferSrc,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+vk::CommandBuffer UploadContext::recording()
+{
+    if (!open_.cb)
+    {
+        open_.ticket = nextTicket_++;
+        open_.cb = std::move(dev_.allocateCommandBuffersUnique(vk::CommandBufferAllocateInfo{
+            pool_.get(), vk::CommandBufferLevel::ePrimary, 1 })[0]);
+        open_.fence = dev_.createFenceUnique(vk::FenceCreateInfo{});
+        open_.cb->begin(vk::CommandBufferBeginInfo{ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+    }
+    return open_.cb.get();
+}
+
+vk::DeviceSize UploadContext::stage(const void* data, vk::DeviceSize bytes, vk::Buffer& src)
+{
+    if (bytes > ring_.capacity())
+    {
+        recording();
+        Buffer tmp = create_buffer(*alloc_, bytes, vk::BufferUsageFlagBits::eTransferSrc,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        std::memcpy(tmp.mem.mapped(), data, (size_t)bytes);
+        src = tmp.buf.get();
+        open_.temps.push_back(std::move(tmp));
+        return 0;
+    }
+
+    std::optional<uint64_t> offset;
+    while (!(offset = ring_.find(bytes)))
+    {
+        // Ring full: push out what is recorded so far, then wait for the oldest batch.
+        if (inFlight_.empty()) submit();
+        retire(true);
+    }
+
+    recording();
+    ring_.occupy(*offset, bytes, open_.ticket);
+    std::memcpy(static_cast<std::byte*>(staging_.mem.mapped()) + *offset, data, (size_t)bytes);
+    src = staging_.buf.get();
+    return *offset;
+}
+
+void UploadContext::upload_buffer(vk::Buffer dst, vk::DeviceSize dstOffset, const void* data, vk::DeviceSize bytes)
+{
+    if (bytes == 0) return;
+    vk::Buffer src{};
+    const vk::DeviceSize srcOffset = stage(data, bytes, src);
+    recording().copyBuffer(src, dst, vk::BufferCopy{ srcOffset, dstOffset, bytes });
+
+    if (releases())
+    {
+        vk::BufferMemoryBarrier b{ vk::AccessFlagBits::eTransferWrite, {}, family_, ownerFamily_, dst, dstOffset, bytes };
+        release_.buffers.push_back(b);
+        b.srcAccessMask = {};
+        b.dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+        acquire_.buffers.push_back(b);
+    }
+}
+
+void UploadContext::upload_image(vk::Image dst, uint32_t w, uint32_t h, const void* data, vk::DeviceSize bytes, vk::ImageLayout finalLayout)
+{
+    if (bytes == 0) return;
+    vk::Buffer src{};
+    const vk::DeviceSize srcOffset = stage(data, bytes, src);
+    vk::CommandBuffer cb = recording();
+
+    vk::ImageMemoryBarrier barrier{};
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = dst;
+    barrier.subresourceRange = vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0,1,0,1 };
+
+    barrier.oldLayout = vk::ImageLayout::eUndefined;
+    barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.srcAccessMask = {};
+    barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+    cb.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, 0,nullptr, 0,nullptr, 1,&barrier);
+
+    vk::BufferImageCopy region{};
+    region.bufferOffset = srcOffset;
+    region.imageSubresource = vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, 0,0,1 };
+    region.imageExtent = vk::Extent3D{w,h,1};
+    cb.copyBufferToImage(src, dst, vk::ImageLayout::eTransferDstOptimal, 1, &region);
+
+    barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.newLayout = finalLayout;
+    barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    barrier.dstAccessMask = finalLayout == vk::ImageLayout::eShaderReadOnlyOptimal
+        ? vk::AccessFlagBits::eShaderRead : vk::AccessFlagBits::eMemoryRead;
+
+    if (releases())
+    {
+        // The layout transition rides on the ownership transfer; acquire repeats it verbatim.
+        barrier.srcQueueFamilyIndex = family_;
+        barrier.dstQueueFamilyIndex = ownerFamily_;
+        acquire_.images.push_back(barrier);
+        acquire_.images.back().srcAccessMask = {};
+        barrier.dstAccessMask = {};
+        release_.images.push_back(barrier);
+        return;
+    }
+    cb.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, 0,nullptr, 0,nullptr, 1,&barrier);
+}
+
+UploadTicket UploadContext::submit(vk::Semaphore signal, UploadAcquire* acquire)
+{
+    if (!open_.cb)
+    {
+        if (!signal) return UploadTicket{ nextTicket_ - 1 };
+        recording(); // an empty batch still signals the semaphore and hands out pending acquires
+    }
+
+    if (releases())
+    {
+        open_.cb->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {},
+            0,nullptr,
+            (uint32_t)release_.buffers.size(), release_.buffers.data(),
+            (uint32_t)release_.images.size(), release_.images.data());
+        release_ = UploadAcquire{};
+    }
+    else
+    {
+        // Later submissions on this queue see the copied buffer contents without further barriers.
+        const vk::MemoryBarrier visible{ vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead };
+        open_.cb->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, 1,&visible, 0,nullptr, 0,nullptr);
+    }
+    open_.cb->end();
+
+    vk::CommandBuffer cbh = open_.cb.get();
+    vk::SubmitInfo si{ 0,nullptr,nullptr, 1,&cbh, signal ? 1u : 0u, &signal };
+    {
+        std::unique_lock<std::mutex> lock;
+        if (queueMutex_) lock = std::unique_lock<std::mutex>(*queueMutex_);
+        queue_.submit(si, open_.fence.get());
+    }
+
+    if (acquire) *acquire = std::exchange(acquire_, UploadAcquire{});
+
+    const UploadTicket t{ open_.ticket };
+    inFlight_.push_back(std::move(open_));
+    open_ = Batch{};
+    return t;
+}
+
+void UploadContext::retire(bool block)
+{
+    while (!inFlight_.empty())
+    {
+        Batch& b = inFlight_.front();
+        if (block)
+        {
+            VK_CHECK(dev_.waitForFences(b.fence.get(), true, std::numeric_limits<uint64_t>::max()));
+            block = false;
+        }
+        else if (dev_.getFenceStatus(b.fence.get()) != vk::Result::eSuccess)
+            break;
+
+        completed_ = b.ticket;
+        ring_.release(completed_);
+        inFlight_.pop_front();
+    }
+}
+
+bool UploadContext::is_complete(UploadTicket t)
+{
+    retire(false);
+    return completed_ >= t.value;
+}
+
+void UploadContext::wait(UploadTicket t)
+{
+    if (open_.cb && t.value >= open_.ticket) submit();
+    while (completed_ < t.value && !inFlight_.empty())
+        retire(true);
+}
+
+} // namespace vkmini
@@ -1,19 +1,62 @@
 #include "vk_validation.hpp"
-#include <iostream>
+#include "debug_sink.hpp"
+#include <atomic>
 #include <cstring>
+#include <iostream>
+#include <sstream>
 
 namespace vkmini {
+namespace {
+
+static DebugSeverity severity_of(VkDebugUtilsMessageSeverityFlagBitsEXT s)
+{
+    if (s & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) return DebugSeverity::Error;
+    if (s & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) return DebugSeverity::Warning;
+    if (s & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) return DebugSeverity::Info;
+    return DebugSeverity::Verbose;
+}
+
+// Started with the first message; stopped (after writing what is queued) at exit.
+std::atomic<bool> sinkStarted{false};
+DebugSink& sink()
+{
+    static DebugSink s(std::cerr);
+    sinkStarted.store(true, std::memory_order_release);
+    return s;
+}
+
+} // namespace
 
 VkBool32 VKAPI_CALL debug_callback(
-    VkDebugUtilsMessageSeverityFlagBitsEXT,
-    VkDebugUtilsMessageTypeFlagsEXT,
+    VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+    VkDebugUtilsMessageTypeFlagsEXT types,
     const VkDebugUtilsMessengerCallbackDataEXT* data,
     void*)
 {
-    std::cerr << "validation: " << (data && data->pMessage ? data->pMessage : "(null)") << "\n";
+    sink().post(severity_of(severity), types & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
+                data ? data->messageIdNumber : 0, data ? data->pMessageIdName : nullptr,
+                data ? data->pMessage : nullptr);
     return VK_FALSE;
 }
 
+DebugMessageStats debug_message_stats()
+{
+    if (!sinkStarted.load(std::memory_order_acquire)) return {}; // no messages: no writer thread
+    sink().flush();
+    return sink().stats();
+}
+
+std::string format_debug_message_stats()
+{
+    const DebugMessageStats st = debug_message_stats();
+    if (!st.errors && !st.warnings && !st.info && !st.verbose) return {};
+    std::ostringstream os;
+    os << "[Vulkan] Debug messages: " << st.errors << " errors, " << st.warnings << " warnings, "
+       << st.info << " info, " << st.verbose << " verbose; " << st.performance << " performance; "
+       << st.repeats << " repeats folded, " << st.rateLimited << " rate-limited, " << st.dropped << " dropped\n";
+    return os.str();
+}
+
 ValidationConfig make_validation_config()
 {
     ValidationConfig cfg{};